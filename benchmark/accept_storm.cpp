@@ -0,0 +1,135 @@
+#include "../include/ghettp.hpp"
+#include "bench_util.hpp"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+using namespace ghettp;
+
+static void serve(int port, const server_options& options) {
+    server app(port, options);
+    app.get("/", [](const HttpRequestView& req) {
+        return server::text("ok");
+    });
+    app.start(io_model::epoll);
+    pause();
+}
+
+static int connectWithTimeout(int port, int milliseconds) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    timeval timeout{milliseconds / 1000, (milliseconds % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+struct storm_result {
+    double seconds = 0;
+    long completed = 0;
+    long failed = 0;
+    std::vector<double> latencies;
+};
+
+static storm_result storm(int port, int burst, int rounds, int timeout) {
+    const std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+    storm_result result;
+    std::mutex result_mutex;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        std::atomic<bool> go{false};
+        std::vector<std::thread> clients;
+        for (int i = 0; i < burst; ++i) {
+            clients.emplace_back([&]() {
+                while (!go) {
+                    std::this_thread::yield();
+                }
+                auto begin = std::chrono::steady_clock::now();
+                int fd = connectWithTimeout(port, timeout);
+                bool ok = fd >= 0 && bench::sendAll(fd, request) && bench::readUntilClose(fd) > 0;
+                double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+                if (fd >= 0) {
+                    close(fd);
+                }
+
+                std::lock_guard<std::mutex> lock(result_mutex);
+                if (ok) {
+                    ++result.completed;
+                    result.latencies.push_back(elapsed);
+                } else {
+                    ++result.failed;
+                }
+            });
+        }
+        go = true;
+        for (auto& client : clients) {
+            client.join();
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::sort(result.latencies.begin(), result.latencies.end());
+    return result;
+}
+
+static double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()))];
+}
+
+int main(int argc, char** argv) {
+    int burst = argc > 1 ? std::atoi(argv[1]) : 256;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    int timeout = argc > 3 ? std::atoi(argv[3]) : 3000;
+
+    server_options legacy;
+    legacy.listen_backlog = 5;
+    legacy.accept_batch = 1;
+    legacy.tcp_nodelay = false;
+
+    server_options deferred;
+    deferred.tcp_defer_accept = 1;
+
+    struct {
+        const char* name;
+        server_options options;
+        int port;
+    } runs[] = {
+        {"backlog=5", legacy, 18121},
+        {"default", server_options(), 18122},
+        {"defer", deferred, 18123},
+    };
+
+    std::cout << std::left << std::setw(12) << "listener" << std::setw(10) << "conn/s" << std::setw(10) << "failed"
+              << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "max ms"
+              << ">1s" << std::endl;
+    for (const auto& run : runs) {
+        pid_t pid = bench::spawnServer([&]() { serve(run.port, run.options); });
+        storm_result result = storm(run.port, burst, rounds, timeout);
+        long slow = std::count_if(result.latencies.begin(), result.latencies.end(),
+                                  [](double latency) { return latency >= 1000; });
+        std::cout << std::left << std::setw(12) << run.name << std::fixed << std::setprecision(0) << std::setw(10)
+                  << result.completed / result.seconds << std::setw(10) << result.failed << std::setprecision(2)
+                  << std::setw(10) << percentile(result.latencies, 0.5) << std::setw(10)
+                  << percentile(result.latencies, 0.99) << std::setw(10)
+                  << (result.latencies.empty() ? 0 : result.latencies.back()) << slow << std::endl;
+        bench::stopServer(pid);
+    }
+    return 0;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+inline int connectTo(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int opt = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+inline bool sendAll(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t sent = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        offset += sent;
+    }
+    return true;
+}
+
+inline size_t readUntilClose(int fd) {
+    char buffer[16384];
+    size_t total = 0;
+    ssize_t bytes_read;
+    while ((bytes_read = read(fd, buffer, sizeof(buffer))) > 0) {
+        total += bytes_read;
+    }
+    return total;
+}
+
+inline bool fetch(int fd, const std::string& request, std::vector<char>& buffer) {
+    if (!sendAll(fd, request)) {
+        return false;
+    }
+
+    std::string head;
+    while (head.find("\r\n\r\n") == std::string::npos) {
+        ssize_t bytes_read = read(fd, buffer.data(), buffer.size());
+        if (bytes_read <= 0) {
+            return false;
+        }
+        head.append(buffer.data(), bytes_read);
+    }
+    size_t body_received = head.size() - (head.find("\r\n\r\n") + 4);
+
+    size_t length_at = head.find("Content-Length: ");
+    if (length_at == std::string::npos) {
+        return false;
+    }
+    size_t content_length = std::strtoul(head.c_str() + length_at + 16, nullptr, 10);
+    while (body_received < content_length) {
+        ssize_t bytes_read = read(fd, buffer.data(), std::min(buffer.size(), content_length - body_received));
+        if (bytes_read <= 0) {
+            return false;
+        }
+        body_received += bytes_read;
+    }
+    return true;
+}
+
+inline double drive(int port, const std::string& path, int connections, int seconds,
+                    size_t buffer_size = 64 * 1024) {
+    const std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+    std::atomic<bool> running{true};
+    std::atomic<long> completed{0};
+    std::vector<std::thread> clients;
+    for (int i = 0; i < connections; ++i) {
+        clients.emplace_back([&]() {
+            std::vector<char> buffer(buffer_size);
+            int fd = -1;
+            while (running) {
+                if (fd < 0 && (fd = connectTo(port)) < 0) {
+                    continue;
+                }
+                if (!fetch(fd, request, buffer)) {
+                    close(fd);
+                    fd = -1;
+                    continue;
+                }
+                ++completed;
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    running = false;
+    for (auto& client : clients) {
+        client.join();
+    }
+    return static_cast<double>(completed) / seconds;
+}
+
+inline std::string procStatus(pid_t pid, const std::string& key) {
+    std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, key.size() + 1, key + ":") == 0) {
+            size_t start = line.find_first_not_of(" \t", key.size() + 1);
+            return start == std::string::npos ? "" : line.substr(start);
+        }
+    }
+    return "?";
+}
+
+inline pid_t spawnServer(const std::function<void()>& body) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        body();
+        _exit(0);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    return pid;
+}
+
+inline void stopServer(pid_t pid) {
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+}
+
+}
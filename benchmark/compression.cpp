@@ -0,0 +1,78 @@
+#include "../include/compression.hpp"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <zlib.h>
+
+using namespace ghettp;
+
+static std::string jsonPayload(size_t items) {
+    std::string body = "[";
+    for (size_t i = 0; i < items; ++i) {
+        body += "{\"id\":" + std::to_string(i) + ",\"name\":\"user" + std::to_string(i % 97) +
+                "\",\"active\":" + (i % 3 ? "true" : "false") + ",\"tags\":[\"alpha\",\"beta\"]},";
+    }
+    body.back() = ']';
+    return body;
+}
+
+static bool freshGzip(const std::string& input, int level, std::string& output) {
+    z_stream stream{};
+    if (deflateInit2(&stream, level, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    output.resize(deflateBound(&stream, static_cast<uLong>(input.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+    stream.avail_out = static_cast<uInt>(output.size());
+    bool done = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    return done;
+}
+
+template <typename Compress>
+static void report(const char* name, const std::string& input, int iterations, Compress compress) {
+    std::string output;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        if (!compress(input, output)) {
+            std::cout << std::left << std::setw(16) << name << "unavailable" << std::endl;
+            return;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::left << std::setw(16) << name << std::setw(10) << input.size() << std::setw(10)
+              << output.size() << std::fixed << std::setprecision(1) << std::setw(8)
+              << static_cast<double>(input.size()) / output.size() << std::setw(12)
+              << seconds * 1e6 / iterations << static_cast<double>(input.size()) * iterations / seconds / (1 << 20)
+              << std::endl;
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 2000;
+    compression_options options;
+
+    std::cout << std::left << std::setw(16) << "coding" << std::setw(10) << "bytes" << std::setw(10) << "encoded"
+              << std::setw(8) << "ratio" << std::setw(12) << "us/body"
+              << "MB/s" << std::endl;
+
+    for (size_t items : {20, 200, 2000}) {
+        std::string input = jsonPayload(items);
+        for (content_coding coding : {content_coding::gzip, content_coding::deflate, content_coding::brotli,
+                                      content_coding::zstd}) {
+            std::string name(codingName(coding));
+            report(name.c_str(), input, iterations, [&](const std::string& body, std::string& output) {
+                return compress(body, coding, options, output);
+            });
+        }
+        report("gzip (fresh)", input, iterations, [&](const std::string& body, std::string& output) {
+            return freshGzip(body, options.gzip_level, output);
+        });
+        std::cout << std::endl;
+    }
+    return 0;
+}
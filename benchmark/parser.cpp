@@ -0,0 +1,91 @@
+#include "../include/http_parser.hpp"
+#include "../include/http_scan.hpp"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+using namespace ghettp;
+
+static const struct {
+    const char* name;
+    const char* request;
+} header_sets[] = {
+    {"browser",
+     "GET /wp-content/uploads/2010/03/hello-kitty-darth-vader-pink.jpg HTTP/1.1\r\n"
+     "Host: www.kittyhell.com\r\n"
+     "User-Agent: Mozilla/5.0 (Macintosh; U; Intel Mac OS X 10.6; ja-JP-mac; rv:1.9.2.3) "
+     "Gecko/20100401 Firefox/3.6.3 Pathtraq/0.9\r\n"
+     "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+     "Accept-Language: ja,en-us;q=0.7,en;q=0.3\r\n"
+     "Accept-Encoding: gzip,deflate\r\n"
+     "Accept-Charset: Shift_JIS,utf-8;q=0.7,*;q=0.7\r\n"
+     "Keep-Alive: 115\r\n"
+     "Connection: keep-alive\r\n"
+     "Cookie: wp_ozh_wsa_visits=2; wp_ozh_wsa_visit_lasttime=xxxxxxxxxx; "
+     "__utma=xxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.x; "
+     "__utmz=xxxxxxxxx.xxxxxxxxxx.x.x.utmccn=(referral)|utmcsr=reader.livedoor.com|utmcct=/reader/|utmcmd=referral\r\n"
+     "\r\n"},
+    {"curl",
+     "GET /api/status HTTP/1.1\r\n"
+     "Host: localhost:8080\r\n"
+     "User-Agent: curl/7.88.1\r\n"
+     "Accept: */*\r\n"
+     "\r\n"},
+    {"lb-probe",
+     "GET /health HTTP/1.1\r\n"
+     "Host: 10.0.0.12\r\n"
+     "Connection: close\r\n"
+     "\r\n"},
+};
+
+static double measure(std::string request, int iterations) {
+    http_parser parser(8192, 1024 * 1024);
+    HttpRequestView view;
+    size_t checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        parser.reset();
+        http_parser::result result = parser.parse(request.data(), request.size());
+        if (result == http_parser::result::head) {
+            result = parser.parse(request.data(), request.size());
+        }
+        if (result != http_parser::result::complete) {
+            return -1;
+        }
+        parser.view(request.data(), view);
+        checksum += view.headers.size();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    if (checksum == 0) {
+        return -1;
+    }
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    const char* implementations[] = {"scalar", "sse4.2", "avx2"};
+
+    std::cout << std::left << std::setw(10) << "scanner";
+    for (const auto& set : header_sets) {
+        std::cout << std::setw(12) << set.name;
+    }
+    std::cout << "(ns/request)" << std::endl;
+
+    for (const char* implementation : implementations) {
+        if (!useScanImplementation(implementation)) {
+            continue;
+        }
+        std::cout << std::left << std::setw(10) << implementation;
+        for (const auto& set : header_sets) {
+            std::cout << std::setw(12) << std::fixed << std::setprecision(1)
+                      << measure(set.request, iterations);
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include "../include/ghettp.hpp"
+#include "bench_util.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace ghettp;
+
+static void serve(int port, io_model model) {
+    server_options options;
+    options.reuse_port = model == io_model::sharded;
+    server app(port, options);
+    app.get("/health", [](const HttpRequest& req) {
+        return server::text("OK");
+    });
+    app.start(model);
+    pause();
+}
+
+static size_t responseSize(int port, const std::string& request) {
+    int fd = bench::connectTo(port);
+    bench::sendAll(fd, request);
+    char buffer[4096];
+    ssize_t bytes_read = read(fd, buffer, sizeof(buffer));
+    close(fd);
+    return bytes_read > 0 ? static_cast<size_t>(bytes_read) : 0;
+}
+
+static double drive(int port, int connections, int depth, int seconds) {
+    const std::string request = "GET /health HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    size_t response_size = responseSize(port, request);
+    if (response_size == 0) {
+        return 0;
+    }
+
+    std::string batch;
+    for (int i = 0; i < depth; ++i) {
+        batch += request;
+    }
+    size_t batch_response = response_size * depth;
+
+    std::atomic<bool> running{true};
+    std::atomic<long> completed{0};
+    std::vector<std::thread> clients;
+    for (int i = 0; i < connections; ++i) {
+        clients.emplace_back([&]() {
+            std::vector<char> buffer(batch_response);
+            int fd = -1;
+            while (running) {
+                if (fd < 0 && (fd = bench::connectTo(port)) < 0) {
+                    continue;
+                }
+                if (!bench::sendAll(fd, batch)) {
+                    close(fd);
+                    fd = -1;
+                    continue;
+                }
+                size_t received = 0;
+                while (received < batch_response) {
+                    ssize_t bytes_read = read(fd, buffer.data(), batch_response - received);
+                    if (bytes_read <= 0) {
+                        break;
+                    }
+                    received += bytes_read;
+                }
+                if (received < batch_response) {
+                    close(fd);
+                    fd = -1;
+                    continue;
+                }
+                completed += depth;
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    running = false;
+    for (auto& client : clients) {
+        client.join();
+    }
+    return static_cast<double>(completed) / seconds;
+}
+
+int main(int argc, char** argv) {
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+    int connections = argc > 2 ? std::atoi(argv[2]) : 16;
+
+    struct {
+        const char* name;
+        io_model model;
+        int port;
+    } runs[] = {
+        {"threaded", io_model::threaded, 18101},
+        {"epoll", io_model::epoll, 18102},
+        {"sharded", io_model::sharded, 18103},
+    };
+    const int depths[] = {1, 8, 32};
+
+    std::cout << std::left << std::setw(10) << "model" << std::setw(8) << "depth" << "req/s" << std::endl;
+    for (const auto& run : runs) {
+        pid_t pid = bench::spawnServer([&]() { serve(run.port, run.model); });
+        for (int depth : depths) {
+            double rate = drive(run.port, connections, depth, seconds);
+            std::cout << std::left << std::setw(10) << run.name << std::setw(8) << depth << std::fixed
+                      << std::setprecision(0) << rate << std::endl;
+        }
+        bench::stopServer(pid);
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "../include/ghettp.hpp"
+#include "bench_util.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace ghettp;
+
+static void serve(int port, io_model model) {
+    server_options options;
+    options.reuse_port = model == io_model::sharded;
+    server app(port, options);
+    app.get("/", [](const HttpRequest& req) {
+        return server::text("Hello, World!");
+    });
+    app.start(model);
+    pause();
+}
+
+static double drive(int port, int connections, int seconds) {
+    std::atomic<bool> running{true};
+    std::atomic<long> completed{0};
+    const std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+
+    std::vector<std::thread> clients;
+    for (int i = 0; i < connections; ++i) {
+        clients.emplace_back([&]() {
+            while (running) {
+                int fd = bench::connectTo(port);
+                if (fd < 0) {
+                    continue;
+                }
+                if (bench::sendAll(fd, request) && bench::readUntilClose(fd) > 0) {
+                    ++completed;
+                }
+                close(fd);
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    running = false;
+    for (auto& client : clients) {
+        client.join();
+    }
+    return static_cast<double>(completed) / seconds;
+}
+
+int main(int argc, char** argv) {
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+    int connections = argc > 2 ? std::atoi(argv[2]) : 64;
+
+    struct {
+        const char* name;
+        io_model model;
+        int port;
+    } runs[] = {
+        {"threaded", io_model::threaded, 18081},
+        {"epoll", io_model::epoll, 18082},
+        {"sharded", io_model::sharded, 18083},
+    };
+
+    std::cout << std::left << std::setw(10) << "model" << std::setw(14) << "req/s"
+              << std::setw(14) << "VmRSS" << std::setw(14) << "VmHWM" << "threads" << std::endl;
+
+    for (const auto& run : runs) {
+        pid_t pid = bench::spawnServer([&]() { serve(run.port, run.model); });
+        double rate = drive(run.port, connections, seconds);
+        std::cout << std::left << std::setw(10) << run.name << std::setw(14) << std::fixed
+                  << std::setprecision(0) << rate << std::setw(14) << bench::procStatus(pid, "VmRSS")
+                  << std::setw(14) << bench::procStatus(pid, "VmHWM") << bench::procStatus(pid, "Threads")
+                  << std::endl;
+        bench::stopServer(pid);
+    }
+
+    return 0;
+}
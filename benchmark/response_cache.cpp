@@ -0,0 +1,44 @@
+#include "../include/ghettp.hpp"
+#include "bench_util.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+using namespace ghettp;
+
+static HttpResponse render(const HttpRequestView& request) {
+    std::string body = "[";
+    for (int i = 0; i < 500; ++i) {
+        body += "{\"id\":" + std::to_string(i) + ",\"item\":\"" + std::string(request.param("name")) + "\"},";
+    }
+    body.back() = ']';
+    return server::json(body);
+}
+
+static void serve(int port) {
+    server app(port);
+    route_options cached;
+    cached.cache_ttl = std::chrono::milliseconds(1000);
+    app.get("/render/:name", render);
+    app.get("/cached/:name", render, cached);
+    app.start(io_model::epoll);
+    pause();
+}
+
+int main(int argc, char** argv) {
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+    int connections = argc > 2 ? std::atoi(argv[2]) : 8;
+    const int port = 18112;
+
+    pid_t pid = bench::spawnServer([&]() { serve(port); });
+
+    std::cout << std::left << std::setw(10) << "route" << "req/s" << std::endl;
+    for (const char* path : {"/render/widget", "/cached/widget"}) {
+        double rate = bench::drive(port, path, connections, seconds);
+        std::cout << std::left << std::setw(10) << std::string(path + 1, 6) << std::fixed << std::setprecision(0)
+                  << rate << std::endl;
+    }
+
+    bench::stopServer(pid);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "../include/router.hpp"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace ghettp;
+
+int main(int argc, char** argv) {
+    int resources = argc > 1 ? std::atoi(argv[1]) : 400;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    router routes;
+    std::map<std::string, RequestViewHandler, std::less<>> exact;
+    std::vector<std::string> static_paths;
+    std::vector<std::string> param_paths;
+
+    for (int i = 0; i < resources; ++i) {
+        std::string base = "/api/v1/resource" + std::to_string(i);
+        routes.add(base, route{});
+        routes.add(base + "/:id", route{});
+        routes.add(base + "/:id/items/:item", route{});
+        routes.add(base + "/:id/files/*path", route{});
+        exact[base] = RequestViewHandler();
+
+        static_paths.push_back(base);
+        param_paths.push_back(base + "/" + std::to_string(i * 7) + "/items/" + std::to_string(i * 13));
+        param_paths.push_back(base + "/" + std::to_string(i * 3) + "/files/docs/readme.txt");
+    }
+
+    RouteParams params;
+    size_t hits = 0;
+    auto timeLookups = [&](const std::vector<std::string>& paths, auto&& lookup) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            for (const auto& path : paths) {
+                hits += lookup(path);
+            }
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / (static_cast<double>(paths.size()) * iterations);
+    };
+
+    double radix_static = timeLookups(static_paths, [&](const std::string& path) {
+        return routes.find(path, params) != nullptr;
+    });
+    double radix_params = timeLookups(param_paths, [&](const std::string& path) {
+        return routes.find(path, params) != nullptr;
+    });
+    double map_static = timeLookups(static_paths, [&](const std::string& path) {
+        return exact.find(path) != exact.end();
+    });
+
+    std::cout << routes.size() << " routes, " << hits << " hits" << std::endl;
+    std::cout << std::left << std::setw(28) << "lookup" << "ns/lookup" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::left << std::setw(28) << "radix static" << radix_static << std::endl;
+    std::cout << std::left << std::setw(28) << "radix params/wildcard" << radix_params << std::endl;
+    std::cout << std::left << std::setw(28) << "std::map exact (static)" << map_static << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "../include/ghettp.hpp"
+#include "bench_util.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+using namespace ghettp;
+
+static void serve(int port, const std::string& directory) {
+    server app(port);
+    app.serve_static("/static", directory);
+    app.get("/read/:name", [directory](const HttpRequestView& req) {
+        std::ifstream file(directory + "/" + std::string(req.param("name")), std::ios::binary);
+        std::ostringstream body;
+        body << file.rdbuf();
+        HttpResponse response;
+        response.headers["Content-Type"] = "application/octet-stream";
+        response.body = body.str();
+        return response;
+    });
+    app.start(io_model::epoll);
+    pause();
+}
+
+int main(int argc, char** argv) {
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+    int connections = argc > 2 ? std::atoi(argv[2]) : 8;
+    const int port = 18111;
+
+    char directory[] = "/tmp/ghettp_static_XXXXXX";
+    if (!mkdtemp(directory)) {
+        std::cerr << "Failed to create benchmark directory" << std::endl;
+        return 1;
+    }
+
+    struct {
+        const char* name;
+        size_t size;
+    } files[] = {
+        {"1k.bin", 1024},
+        {"100k.bin", 100 * 1024},
+        {"10m.bin", 10 * 1024 * 1024},
+    };
+    for (const auto& file : files) {
+        std::ofstream out(std::string(directory) + "/" + file.name, std::ios::binary);
+        out << std::string(file.size, 'x');
+    }
+
+    pid_t pid = bench::spawnServer([&]() { serve(port, directory); });
+
+    std::cout << std::left << std::setw(10) << "file" << std::setw(10) << "path" << std::setw(12) << "req/s"
+              << "MB/s" << std::endl;
+    for (const auto& file : files) {
+        const std::pair<const char*, std::string> paths[] = {
+            {"sendfile", std::string("/static/") + file.name},
+            {"body", std::string("/read/") + file.name},
+        };
+        for (const auto& path : paths) {
+            double rate = bench::drive(port, path.second, connections, seconds, 256 * 1024);
+            std::cout << std::left << std::setw(10) << file.name << std::setw(10) << path.first << std::fixed
+                      << std::setprecision(0) << std::setw(12) << rate << std::setprecision(1)
+                      << rate * file.size / (1024 * 1024) << std::endl;
+        }
+    }
+
+    bench::stopServer(pid);
+    for (const auto& file : files) {
+        unlink((std::string(directory) + "/" + file.name).c_str());
+    }
+    rmdir(directory);
+    return 0;
+}
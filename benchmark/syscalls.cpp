@@ -0,0 +1,125 @@
+#include "../include/ghettp.hpp"
+#include "bench_util.hpp"
+#include <sys/mman.h>
+#include <sys/ptrace.h>
+#include <iostream>
+#include <iomanip>
+
+using namespace ghettp;
+
+struct trace_state {
+    std::atomic<long> syscall_stops{0};
+    std::atomic<pid_t> server_pid{0};
+};
+
+static void serve(int port, io_model model, io_backend backend) {
+    server_options options;
+    options.backend = backend;
+    server app(port, options);
+    app.get("/", [](const HttpRequest& req) {
+        return server::text("Hello, World!");
+    });
+    app.start(model);
+    pause();
+}
+
+static void trace(trace_state* state, const std::function<void()>& body) {
+    pid_t child = fork();
+    if (child == 0) {
+        ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
+        raise(SIGSTOP);
+        body();
+        _exit(0);
+    }
+
+    int status;
+    waitpid(child, &status, 0);
+    ptrace(PTRACE_SETOPTIONS, child, nullptr,
+           PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE | PTRACE_O_EXITKILL);
+    ptrace(PTRACE_SYSCALL, child, nullptr, nullptr);
+    state->server_pid = child;
+
+    while (true) {
+        pid_t pid = waitpid(-1, &status, __WALL);
+        if (pid < 0) {
+            break;
+        }
+        if (WIFEXITED(status) || WIFSIGNALED(status)) {
+            if (pid == child) {
+                break;
+            }
+            continue;
+        }
+
+        int signal = 0;
+        if (WIFSTOPPED(status)) {
+            int stop = WSTOPSIG(status);
+            if (stop == (SIGTRAP | 0x80)) {
+                ++state->syscall_stops;
+            } else if (stop != SIGTRAP && stop != SIGSTOP) {
+                signal = stop;
+            }
+        }
+        ptrace(PTRACE_SYSCALL, pid, nullptr, reinterpret_cast<void*>(static_cast<long>(signal)));
+    }
+}
+
+static double measure(int port, io_model model, io_backend backend, int requests) {
+    void* shared = mmap(nullptr, sizeof(trace_state), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    trace_state* state = new (shared) trace_state();
+
+    pid_t tracer = fork();
+    if (tracer == 0) {
+        trace(state, [&]() { serve(port, model, backend); });
+        _exit(0);
+    }
+
+    while (state->server_pid == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    const std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+    long before = state->syscall_stops;
+    for (int i = 0; i < requests; ++i) {
+        int fd = bench::connectTo(port);
+        if (fd < 0) {
+            continue;
+        }
+        bench::sendAll(fd, request);
+        bench::readUntilClose(fd);
+        close(fd);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    long after = state->syscall_stops;
+
+    kill(state->server_pid, SIGKILL);
+    bench::stopServer(tracer);
+    munmap(shared, sizeof(trace_state));
+
+    return static_cast<double>(after - before) / 2.0 / requests;
+}
+
+int main(int argc, char** argv) {
+    int requests = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+    struct {
+        const char* name;
+        io_model model;
+        io_backend backend;
+        int port;
+    } runs[] = {
+        {"posix/threaded", io_model::threaded, io_backend::posix, 18091},
+        {"posix/epoll", io_model::epoll, io_backend::posix, 18092},
+        {"io_uring", io_model::epoll, io_backend::io_uring, 18093},
+    };
+
+    std::cout << std::left << std::setw(18) << "backend" << "syscalls/request" << std::endl;
+    for (const auto& run : runs) {
+        double per_request = measure(run.port, run.model, run.backend, requests);
+        std::cout << std::left << std::setw(18) << run.name << std::fixed << std::setprecision(2)
+                  << per_request << std::endl;
+    }
+
+    return 0;
+}
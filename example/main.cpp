@@ -63,17 +63,7 @@ int main() {
             return server::json(response);
         });
 
-        app.get("/hello", [](const HttpRequest& req) {
-            std::string name = "World";
-            auto query_pos = req.path.find('?');
-            if (query_pos != std::string::npos) {
-                std::string query = req.path.substr(query_pos + 1);
-                auto name_pos = query.find("name=");
-                if (name_pos != std::string::npos) {
-                    name = query.substr(name_pos + 5);
-                }
-            }
-
+        auto greeting = [](const std::string& name) {
             std::string html = R"(
 <!DOCTYPE html>
 <html>
@@ -91,6 +81,19 @@ int main() {
 </html>
             )";
             return server::html(html);
+        };
+
+        app.get("/hello", [greeting](const HttpRequest& req) {
+            std::string name = "World";
+            auto name_pos = req.query.find("name=");
+            if (name_pos != std::string::npos) {
+                name = req.query.substr(name_pos + 5);
+            }
+            return greeting(name);
+        });
+
+        app.get("/hello/:name", [greeting](const HttpRequestView& req) {
+            return greeting(std::string(req.param("name")));
         });
         std::cout << "Press Ctrl+C to stop the server" << std::endl;
 
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "socket.hpp"
+#include <string>
+#include <string_view>
+
+namespace ghettp {
+
+enum class content_coding {
+    identity,
+    deflate,
+    gzip,
+    zstd,
+    brotli
+};
+
+std::string_view codingName(content_coding coding);
+bool codingAvailable(content_coding coding);
+int acceptQuality(std::string_view accept_encoding, content_coding coding);
+content_coding negotiateEncoding(std::string_view accept_encoding);
+
+bool compressibleType(std::string_view content_type, const compression_options& options);
+bool compress(std::string_view input, content_coding coding, const compression_options& options, std::string& output);
+void applyCompression(const HttpRequestView& request, HttpResponse& response, const compression_options& options);
+
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "socket.hpp"
+#include <ctime>
+#include <string>
+#include <string_view>
+
+namespace ghettp {
+
+std::string httpDate(time_t time);
+bool parseHttpDate(std::string_view text, time_t& time);
+
+std::string entityTag(const HttpResponse& response);
+bool tagListMatches(std::string_view list, std::string_view tag);
+
+void addValidators(HttpResponse& response);
+bool notModified(const HttpRequestView& request, const HttpResponse& response);
+void makeNotModified(HttpResponse& response);
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <sys/types.h>
+#include <time.h>
+
+namespace ghettp {
+
+struct static_file {
+    int fd = -1;
+    size_t size = 0;
+    ino_t inode = 0;
+    timespec modified{};
+    std::string_view content_type;
+    std::shared_ptr<const static_file> gzip;
+    std::shared_ptr<const static_file> brotli;
+
+    static_file() = default;
+    static_file(const static_file&) = delete;
+    static_file& operator=(const static_file&) = delete;
+    ~static_file();
+};
+
+std::string_view contentType(std::string_view path);
+bool normalizePath(std::string_view path, std::string& out);
+
+class file_cache {
+private:
+    struct entry {
+        std::string path;
+        std::shared_ptr<const static_file> file;
+        std::chrono::steady_clock::time_point checked;
+    };
+
+    int m_directory_fd;
+    size_t m_capacity;
+    std::mutex m_mutex;
+    std::list<entry> m_entries;
+    std::unordered_map<std::string_view, std::list<entry>::iterator> m_index;
+
+    std::string resolve(const std::string& path) const;
+    std::shared_ptr<const static_file> load(const std::string& path) const;
+    bool current(const entry& cached) const;
+
+public:
+    file_cache(const std::string& directory, size_t capacity);
+    ~file_cache();
+    file_cache(const file_cache&) = delete;
+    file_cache& operator=(const file_cache&) = delete;
+
+    std::shared_ptr<const static_file> open(const std::string& path);
+};
+
+}
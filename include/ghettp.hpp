@@ -1,6 +1,11 @@
 #pragma once
 
 #include "socket.hpp"
+#include "router.hpp"
+#include "http_status.hpp"
+#include "response_cache.hpp"
+#include "single_flight.hpp"
+#include <array>
 #include <functional>
 #include <map>
 #include <string>
@@ -11,32 +16,58 @@ namespace ghettp {
 
 using HttpRequest = ghettp::HttpRequest;
 using HttpResponse = ghettp::HttpResponse;
+using HttpRequestView = ghettp::HttpRequestView;
 using RequestHandler = ghettp::RequestHandler;
+using RequestViewHandler = ghettp::RequestViewHandler;
 
 class server {
 private:
     socket m_socket;
-    std::map<std::string, std::map<std::string, RequestHandler>> m_routes;
+    server_options m_options;
+    std::array<router, http_method_count> m_routes;
+    std::array<bool, http_method_count> m_body_routes{};
+    response_cache m_cache;
+    single_flight m_flights;
     std::thread m_server_thread;
     std::atomic<bool> m_running{false};
 
-    HttpResponse routeRequest(const HttpRequest& request);
+    const route* findRoute(http_method method, HttpRequestView& request) const;
+    HttpResponse routeRequest(HttpRequestView& request);
+    bool routeBody(HttpRequestView& request, BodyReader& reader);
+    bool spoolBody(const route& target, const router& routes, BodyReader& reader);
+    void finishResponse(const route& target, const HttpRequestView& request, HttpResponse& response) const;
 
 public:
-    explicit server(int port);
+    explicit server(int port, const server_options& options = server_options());
     ~server();
 
-    void get(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler);
-    void post(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler);
-    void put(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler);
-    void del(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler);
+    void get(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler,
+             const route_options& options = route_options());
+    void post(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler,
+              const route_options& options = route_options());
+    void put(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler,
+             const route_options& options = route_options());
+    void del(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler,
+             const route_options& options = route_options());
+
+    void get(const std::string& path, RequestViewHandler handler, const route_options& options = route_options());
+    void post(const std::string& path, RequestViewHandler handler, const route_options& options = route_options());
+    void put(const std::string& path, RequestViewHandler handler, const route_options& options = route_options());
+    void del(const std::string& path, RequestViewHandler handler, const route_options& options = route_options());
+
+    void post(const std::string& path, StreamingHandler handler, const route_options& options = route_options());
+    void put(const std::string& path, StreamingHandler handler, const route_options& options = route_options());
+
+    void serve_static(const std::string& prefix, const std::string& directory);
 
     static HttpResponse html(const std::string& content, int status_code = 200);
     static HttpResponse json(const std::string& content, int status_code = 200);
     static HttpResponse text(const std::string& content, int status_code = 200);
+    static HttpResponse stream(ResponseStream producer, const std::string& content_type = "text/plain");
 
-    void start();
+    void start(io_model model = io_model::threaded);
     void stop();
+    cache_counters cache_stats() const;
 };
 
 }
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string_view>
+
+namespace ghettp {
+
+std::string_view trim(std::string_view value);
+bool equalsIgnoreCase(std::string_view left, std::string_view right);
+bool nextListItem(std::string_view& list, std::string_view& item);
+bool containsToken(std::string_view list, std::string_view token);
+
+}
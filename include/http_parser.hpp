@@ -0,0 +1,89 @@
+#pragma once
+
+#include "socket.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace ghettp {
+
+http_method parseMethod(const char* data, size_t length);
+std::string_view methodName(http_method method);
+
+class http_parser {
+public:
+    enum class result {
+        incomplete,
+        head,
+        complete,
+        error
+    };
+
+    struct span {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    struct header_span {
+        span name;
+        span value;
+    };
+
+    http_parser(size_t max_header_size, size_t max_body_size);
+
+    result parse(char* data, size_t size);
+    void reset();
+    void streamBody() { m_streaming = true; }
+    size_t releaseBody(char* data, size_t size);
+    size_t bodyRemaining() const { return m_state == state::body ? m_content_length : 0; }
+    void skipBody(size_t length) { m_content_length -= length; }
+
+    size_t consumed() const { return m_consumed; }
+    int errorStatus() const { return m_error_status; }
+    span decodedBody() const { return {body.offset, m_body_end - body.offset}; }
+    void view(const char* data, HttpRequestView& request) const;
+
+    http_method method_id = http_method::unknown;
+    span method;
+    span path;
+    span query;
+    span version;
+    std::vector<header_span> headers;
+    span body;
+
+private:
+    enum class state {
+        request_line,
+        header_line,
+        body,
+        chunk_size,
+        chunk_data,
+        chunk_end,
+        trailer,
+        complete
+    };
+
+    size_t m_max_header_size;
+    size_t m_max_body_size;
+    state m_state = state::request_line;
+    size_t m_offset = 0;
+    size_t m_content_length = 0;
+    size_t m_body_end = 0;
+    size_t m_chunk_remaining = 0;
+    size_t m_trailer_size = 0;
+    size_t m_consumed = 0;
+    int m_error_status = 0;
+    bool m_has_length = false;
+    bool m_chunked = false;
+    bool m_streaming = false;
+
+    result fail(int status_code);
+    result incomplete(size_t size);
+    result parseBody(size_t size);
+    result parseChunked(char* data, size_t size);
+    bool checkBodySize(size_t length);
+    bool parseRequestLine(const char* line, size_t length);
+    bool addHeader(const char* data, size_t name_offset, size_t name_length,
+                   size_t value_offset, size_t value_length);
+};
+
+}
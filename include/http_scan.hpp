@@ -0,0 +1,11 @@
+#pragma once
+
+namespace ghettp {
+
+const char* findTokenEnd(const char* begin, const char* end);
+const char* findValueEnd(const char* begin, const char* end);
+
+const char* scanImplementation();
+bool useScanImplementation(const char* name);
+
+}
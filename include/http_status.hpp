@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+
+namespace ghettp {
+
+struct http_status {
+    int code;
+    std::string_view reason;
+    std::string_view line;
+};
+
+#define GHETTP_STATUS(code, reason) http_status{code, reason, "HTTP/1.1 " #code " " reason "\r\n"}
+
+inline constexpr http_status http_statuses[] = {
+    GHETTP_STATUS(100, "Continue"),
+    GHETTP_STATUS(101, "Switching Protocols"),
+    GHETTP_STATUS(102, "Processing"),
+    GHETTP_STATUS(103, "Early Hints"),
+    GHETTP_STATUS(200, "OK"),
+    GHETTP_STATUS(201, "Created"),
+    GHETTP_STATUS(202, "Accepted"),
+    GHETTP_STATUS(203, "Non-Authoritative Information"),
+    GHETTP_STATUS(204, "No Content"),
+    GHETTP_STATUS(205, "Reset Content"),
+    GHETTP_STATUS(206, "Partial Content"),
+    GHETTP_STATUS(207, "Multi-Status"),
+    GHETTP_STATUS(208, "Already Reported"),
+    GHETTP_STATUS(226, "IM Used"),
+    GHETTP_STATUS(300, "Multiple Choices"),
+    GHETTP_STATUS(301, "Moved Permanently"),
+    GHETTP_STATUS(302, "Found"),
+    GHETTP_STATUS(303, "See Other"),
+    GHETTP_STATUS(304, "Not Modified"),
+    GHETTP_STATUS(305, "Use Proxy"),
+    GHETTP_STATUS(307, "Temporary Redirect"),
+    GHETTP_STATUS(308, "Permanent Redirect"),
+    GHETTP_STATUS(400, "Bad Request"),
+    GHETTP_STATUS(401, "Unauthorized"),
+    GHETTP_STATUS(402, "Payment Required"),
+    GHETTP_STATUS(403, "Forbidden"),
+    GHETTP_STATUS(404, "Not Found"),
+    GHETTP_STATUS(405, "Method Not Allowed"),
+    GHETTP_STATUS(406, "Not Acceptable"),
+    GHETTP_STATUS(407, "Proxy Authentication Required"),
+    GHETTP_STATUS(408, "Request Timeout"),
+    GHETTP_STATUS(409, "Conflict"),
+    GHETTP_STATUS(410, "Gone"),
+    GHETTP_STATUS(411, "Length Required"),
+    GHETTP_STATUS(412, "Precondition Failed"),
+    GHETTP_STATUS(413, "Content Too Large"),
+    GHETTP_STATUS(414, "URI Too Long"),
+    GHETTP_STATUS(415, "Unsupported Media Type"),
+    GHETTP_STATUS(416, "Range Not Satisfiable"),
+    GHETTP_STATUS(417, "Expectation Failed"),
+    GHETTP_STATUS(418, "I'm a teapot"),
+    GHETTP_STATUS(421, "Misdirected Request"),
+    GHETTP_STATUS(422, "Unprocessable Content"),
+    GHETTP_STATUS(423, "Locked"),
+    GHETTP_STATUS(424, "Failed Dependency"),
+    GHETTP_STATUS(425, "Too Early"),
+    GHETTP_STATUS(426, "Upgrade Required"),
+    GHETTP_STATUS(428, "Precondition Required"),
+    GHETTP_STATUS(429, "Too Many Requests"),
+    GHETTP_STATUS(431, "Request Header Fields Too Large"),
+    GHETTP_STATUS(451, "Unavailable For Legal Reasons"),
+    GHETTP_STATUS(500, "Internal Server Error"),
+    GHETTP_STATUS(501, "Not Implemented"),
+    GHETTP_STATUS(502, "Bad Gateway"),
+    GHETTP_STATUS(503, "Service Unavailable"),
+    GHETTP_STATUS(504, "Gateway Timeout"),
+    GHETTP_STATUS(505, "HTTP Version Not Supported"),
+    GHETTP_STATUS(506, "Variant Also Negotiates"),
+    GHETTP_STATUS(507, "Insufficient Storage"),
+    GHETTP_STATUS(508, "Loop Detected"),
+    GHETTP_STATUS(510, "Not Extended"),
+    GHETTP_STATUS(511, "Network Authentication Required"),
+};
+
+#undef GHETTP_STATUS
+
+constexpr int http_status_min = 100;
+constexpr int http_status_max = 599;
+
+constexpr std::array<unsigned char, http_status_max - http_status_min + 1> makeStatusIndex() {
+    std::array<unsigned char, http_status_max - http_status_min + 1> index{};
+    for (size_t i = 0; i < std::size(http_statuses); ++i) {
+        index[http_statuses[i].code - http_status_min] = static_cast<unsigned char>(i + 1);
+    }
+    return index;
+}
+
+inline constexpr auto http_status_index = makeStatusIndex();
+
+constexpr size_t statusSlot(int code) {
+    return code < http_status_min || code > http_status_max ? 0 : http_status_index[code - http_status_min];
+}
+
+constexpr std::string_view reasonPhrase(int code) {
+    size_t slot = statusSlot(code);
+    return slot ? http_statuses[slot - 1].reason : std::string_view();
+}
+
+constexpr std::string_view statusLine(int code) {
+    size_t slot = statusSlot(code);
+    return slot ? http_statuses[slot - 1].line : std::string_view();
+}
+
+}
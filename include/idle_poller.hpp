@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace ghettp {
+
+class idle_poller {
+private:
+    struct parked {
+        size_t requests = 0;
+        uint64_t serial = 0;
+        bool waiting = false;
+    };
+
+    struct expiry {
+        std::chrono::steady_clock::time_point deadline;
+        int fd;
+        uint64_t serial;
+    };
+
+    int m_epoll_fd = -1;
+    int m_wake_fd = -1;
+    std::chrono::milliseconds m_timeout;
+    std::function<void(int)> m_resume;
+    std::mutex m_mutex;
+    std::unordered_map<int, parked> m_parked;
+    std::deque<expiry> m_expiries;
+    uint64_t m_serial = 0;
+    std::atomic<bool> m_stopping{false};
+    std::thread m_thread;
+
+    void poll();
+    int nextTimeout();
+
+public:
+    idle_poller(std::chrono::milliseconds idle_timeout, std::function<void(int)> resume);
+    ~idle_poller();
+    idle_poller(const idle_poller&) = delete;
+    idle_poller& operator=(const idle_poller&) = delete;
+
+    bool park(int client_socket, size_t requests);
+    size_t take(int client_socket);
+    void shutdown();
+};
+
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "socket.hpp"
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ghettp {
+
+using ByteRanges = std::vector<std::pair<size_t, size_t>>;
+
+bool parseRanges(std::string_view header, size_t length, ByteRanges& ranges, bool& satisfiable);
+bool rangeApplies(const HttpRequestView& request, const HttpResponse& response);
+void applyRange(const HttpRequestView& request, HttpResponse& response);
+
+}
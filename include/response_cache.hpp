@@ -0,0 +1,73 @@
+#pragma once
+
+#include "socket.hpp"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ghettp {
+
+struct cache_counters {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+std::string requestKey(const HttpRequestView& request);
+bool cacheableRequest(const HttpRequestView& request);
+bool cacheableResponse(const HttpResponse& response);
+
+class response_cache {
+private:
+    struct vary_record {
+        std::string names;
+        size_t entries = 0;
+    };
+
+    struct entry {
+        const std::string* key = nullptr;
+        std::pair<const std::string, vary_record>* vary = nullptr;
+        std::shared_ptr<const SerializedResponse> response;
+        std::chrono::steady_clock::time_point expires;
+        size_t bytes = 0;
+        bool referenced = false;
+    };
+
+    struct shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, size_t> index;
+        std::unordered_map<std::string, vary_record> vary;
+        std::vector<entry> entries;
+        std::vector<size_t> free;
+        size_t hand = 0;
+        size_t bytes = 0;
+        cache_counters counters;
+    };
+
+    std::unique_ptr<shard[]> m_shards;
+    size_t m_shard_count;
+    size_t m_shard_budget;
+
+    static void appendVary(const HttpRequestView& request, std::string_view names, std::string& key);
+    shard& shardFor(const std::string& primary) const;
+    void evict(shard& target, size_t slot);
+
+public:
+    explicit response_cache(size_t max_bytes);
+    response_cache(const response_cache&) = delete;
+    response_cache& operator=(const response_cache&) = delete;
+
+    std::shared_ptr<const SerializedResponse> find(const HttpRequestView& request);
+    void store(const HttpRequestView& request, const HttpResponse& response,
+               std::shared_ptr<const SerializedResponse> serialized, std::chrono::milliseconds ttl);
+    cache_counters counters() const;
+};
+
+}
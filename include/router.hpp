@@ -0,0 +1,54 @@
+#pragma once
+
+#include "socket.hpp"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ghettp {
+
+using RouteParams = std::vector<std::pair<std::string_view, std::string_view>>;
+
+struct route_options {
+    bool conditional = false;
+    bool ranges = false;
+    size_t spool_threshold = 0;
+    bool compress = true;
+    std::chrono::milliseconds cache_ttl{0};
+    bool coalesce = false;
+};
+
+struct route {
+    RequestViewHandler handler;
+    route_options options;
+    StreamingHandler streaming;
+};
+
+class router {
+private:
+    struct node {
+        std::string prefix;
+        std::string name;
+        std::string indices;
+        std::vector<std::unique_ptr<node>> children;
+        std::unique_ptr<node> param;
+        std::unique_ptr<node> wildcard;
+        std::unique_ptr<route> target;
+    };
+
+    node m_root;
+    size_t m_size = 0;
+
+    static node* insertStatic(node* parent, std::string_view text);
+    static const route* match(const node* current, std::string_view path, RouteParams& params);
+
+public:
+    void add(std::string_view pattern, route target);
+    const route* find(std::string_view path, RouteParams& params) const;
+    size_t size() const { return m_size; }
+};
+
+}
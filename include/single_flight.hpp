@@ -0,0 +1,40 @@
+#pragma once
+
+#include "socket.hpp"
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ghettp {
+
+class single_flight {
+private:
+    struct call {
+        std::mutex mutex;
+        std::condition_variable done;
+        bool finished = false;
+        bool shared = false;
+        size_t waiters = 0;
+        HttpResponse response;
+        std::vector<std::pair<std::string, std::string>> vary;
+        std::exception_ptr error;
+    };
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<call>> m_calls;
+
+    void finish(const std::string& key, call& flight, const HttpRequestView& request, const HttpResponse* response,
+                std::exception_ptr error);
+    static bool matches(const call& flight, const HttpRequestView& request);
+
+public:
+    HttpResponse run(const HttpRequestView& request, const std::function<HttpResponse()>& work);
+};
+
+}
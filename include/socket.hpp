@@ -1,48 +1,196 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <functional>
 #include <map>
+#include <memory>
+#include <utility>
+#include <vector>
 #include <netinet/in.h>
 #include <atomic>
+#include <chrono>
 
 namespace ghettp {
 
 struct HttpRequest {
     std::string method;
     std::string path;
+    std::string query;
     std::string version;
     std::map<std::string, std::string> headers;
+    std::map<std::string, std::string> params;
     std::string body;
+    int body_fd = -1;
+    std::string body_path;
+};
+
+struct static_file;
+
+using ResponseStream = std::function<bool(std::string& chunk)>;
+
+struct SerializedResponse {
+    std::string wire;
+    size_t head_length = 0;
+    bool dated = false;
 };
 
 struct HttpResponse {
     int status_code = 200;
-    std::string status_text = "OK";
+    std::string status_text;
     std::map<std::string, std::string> headers;
     std::string body;
+    std::shared_ptr<const static_file> file;
+    size_t file_offset = 0;
+    size_t file_length = 0;
+    ResponseStream stream;
+    std::shared_ptr<const SerializedResponse> serialized;
+};
+
+enum class http_method {
+    get,
+    head,
+    post,
+    put,
+    del,
+    patch,
+    options,
+    trace,
+    connect,
+    unknown
+};
+
+const size_t http_method_count = static_cast<size_t>(http_method::unknown);
+
+struct HttpRequestView {
+    std::string_view method;
+    http_method method_id = http_method::unknown;
+    std::string_view path;
+    std::string_view query;
+    std::string_view version;
+    std::vector<std::pair<std::string_view, std::string_view>> headers;
+    std::vector<std::pair<std::string_view, std::string_view>> params;
+    std::string_view body;
+    int body_fd = -1;
+    std::string_view body_path;
+
+    std::string_view header(std::string_view name) const;
+    std::string_view param(std::string_view name) const;
+    HttpRequest toRequest() const;
 };
 
 using RequestHandler = std::function<HttpResponse(const HttpRequest&)>;
+using RequestViewHandler = std::function<HttpResponse(const HttpRequestView&)>;
+using RequestDispatcher = std::function<HttpResponse(HttpRequestView&)>;
+
+struct BodyReader {
+    std::function<void(std::string_view chunk)> on_data;
+    RequestDispatcher on_complete;
+    int spool_fd = -1;
+};
+
+using StreamingHandler = std::function<BodyReader(const HttpRequestView&)>;
+using BodyDispatcher = std::function<bool(HttpRequestView&, BodyReader&)>;
+
+enum class io_model {
+    threaded,
+    epoll,
+    sharded
+};
+
+enum class io_backend {
+    posix,
+    io_uring
+};
+
+struct compression_options {
+    bool enabled = true;
+    size_t min_size = 1024;
+    std::vector<std::string> types = {"text/", "application/json", "application/javascript", "application/xml",
+                                      "image/svg+xml"};
+    int gzip_level = 6;
+    int brotli_quality = 4;
+    int zstd_level = 3;
+};
+
+struct server_options {
+    io_backend backend = io_backend::posix;
+    size_t worker_threads = 0;
+    size_t shards = 0;
+    bool reuse_port = false;
+    int listen_backlog = 4096;
+    size_t accept_batch = 64;
+    bool tcp_nodelay = true;
+    int tcp_defer_accept = 0;
+    int tcp_fastopen = 0;
+    int receive_buffer = 0;
+    int send_buffer = 0;
+    size_t queue_depth = 1024;
+    std::chrono::milliseconds idle_timeout{5000};
+    size_t max_requests_per_connection = 1000;
+    size_t max_header_size = 8192;
+    size_t max_body_size = 1024 * 1024;
+    size_t static_cache_entries = 1024;
+    std::string server_name = "ghettp";
+    std::string spool_directory = "/tmp";
+    size_t response_cache_bytes = 64 * 1024 * 1024;
+    compression_options compression;
+};
+
+struct output_queue;
+class idle_poller;
 
 class socket {
 private:
+    struct connection;
+
     int m_port;
+    server_options m_options;
     int m_socket_fd;
+    int m_wake_fd = -1;
     sockaddr_in m_address;
     socklen_t m_addressLength = sizeof(m_address);
     std::atomic<bool> m_running{false};
-    RequestHandler m_request_handler;
+    RequestDispatcher m_request_handler;
+    BodyDispatcher m_body_handler;
+    std::string m_server_headers;
+
+    void runThreaded();
+    int openListener() const;
+    void configureClient(int client_socket) const;
+    void runEpoll();
+    void runSharded();
+    bool runUring(int listen_fd);
+    void eventLoop(int listen_fd);
+    bool serviceConnection(connection& conn);
+    bool readConnection(connection& conn);
+    bool flushConnection(connection& conn);
+    bool waitReadable(int client_socket);
+    void handleClient(int client_socket, idle_poller& idle);
+    void rejectClient(int client_socket);
+    size_t processRequests(connection& conn);
+    bool processRequest(connection& conn);
+    bool feedBody(connection& conn, char* data, size_t size);
+    bool spliceBody(connection& conn);
+    static bool spooling(const connection& conn);
+    static bool openPipe(connection& conn);
+    bool respond(connection& conn, bool allow_keep_alive);
+    bool produceOutput(connection& conn);
 
-    void handleClient(int client_socket);
-    HttpRequest parseRequest(const std::string& raw_request);
-    std::string buildResponse(const HttpResponse& response);
+    static bool wantsKeepAlive(const HttpRequestView& request);
+    static bool expectsContinue(const HttpRequestView& request);
+    std::string errorResponse(int status_code) const;
+    bool buildHeaders(const HttpResponse& response, bool chunked, std::string& out) const;
+    void buildResponseHead(const HttpResponse& response, bool keep_alive, bool chunked, std::string& out) const;
 
 public:
-    explicit socket(int port);
+    explicit socket(int port, const server_options& options = server_options());
     ~socket();
     void setRequestHandler(RequestHandler handler);
-    void run();
+    void setRequestHandler(RequestDispatcher handler);
+    void setBodyHandler(BodyDispatcher handler);
+    std::shared_ptr<const SerializedResponse> serialize(const HttpResponse& response) const;
+    void run(io_model model = io_model::threaded);
     void stop();
 };
 
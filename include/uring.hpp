@@ -0,0 +1,57 @@
+#pragma once
+
+#include <linux/io_uring.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace ghettp {
+
+class uring {
+private:
+    int m_ring_fd = -1;
+    void* m_ring_ptr = nullptr;
+    size_t m_ring_size = 0;
+    io_uring_sqe* m_sqes = nullptr;
+    size_t m_sqes_size = 0;
+
+    unsigned* m_sq_head = nullptr;
+    unsigned* m_sq_tail = nullptr;
+    unsigned* m_sq_array = nullptr;
+    unsigned m_sq_mask = 0;
+    unsigned m_sq_entries = 0;
+    unsigned m_sq_local_tail = 0;
+    unsigned m_to_submit = 0;
+
+    unsigned* m_cq_head = nullptr;
+    unsigned* m_cq_tail = nullptr;
+    unsigned m_cq_mask = 0;
+    io_uring_cqe* m_cqes = nullptr;
+
+    io_uring_buf* m_buf_ring = nullptr;
+    size_t m_buf_ring_size = 0;
+    char* m_buffers = nullptr;
+    unsigned m_buffer_count = 0;
+    unsigned m_buffer_size = 0;
+
+    void release();
+
+public:
+    uring() = default;
+    ~uring();
+    uring(const uring&) = delete;
+    uring& operator=(const uring&) = delete;
+
+    bool init(unsigned entries, unsigned buffer_count, unsigned buffer_size);
+
+    bool reserve(unsigned count);
+    io_uring_sqe* next();
+    int submit(unsigned wait_nr = 0);
+    io_uring_cqe* peek();
+    void advance();
+
+    unsigned bufferSize() const { return m_buffer_size; }
+    const char* buffer(unsigned id) const;
+    void recycle(unsigned id);
+};
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "mpmc_queue.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ghettp {
+
+class worker_pool {
+private:
+    mpmc_queue<int> m_queue;
+    size_t m_queue_depth;
+    std::function<void(int)> m_handler;
+    std::vector<std::thread> m_workers;
+    std::atomic<size_t> m_pending{0};
+    std::atomic<size_t> m_sleeping{0};
+    std::atomic<bool> m_stopping{false};
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+
+    void work();
+
+public:
+    worker_pool(size_t threads, size_t queue_depth, std::function<void(int)> handler);
+    ~worker_pool();
+    worker_pool(const worker_pool&) = delete;
+    worker_pool& operator=(const worker_pool&) = delete;
+
+    bool submit(int client_socket);
+    void shutdown();
+};
+
+}
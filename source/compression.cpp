@@ -0,0 +1,250 @@
+#include "../include/compression.hpp"
+#include "../include/header_tokens.hpp"
+#include <climits>
+#include <memory>
+#include <strings.h>
+#include <zlib.h>
+#ifdef GHETTP_HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+#ifdef GHETTP_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace ghettp {
+
+static int parseQuality(std::string_view value) {
+    value = trim(value);
+    if (value.empty() || (value[0] != '0' && value[0] != '1')) {
+        return 0;
+    }
+    int quality = (value[0] - '0') * 1000;
+    if (value.size() > 1 && value[1] == '.') {
+        int scale = 100;
+        for (size_t i = 2; i < value.size() && i < 5 && value[i] >= '0' && value[i] <= '9'; ++i) {
+            quality += (value[i] - '0') * scale;
+            scale /= 10;
+        }
+    }
+    return std::min(quality, 1000);
+}
+
+struct deflate_context {
+    z_stream stream{};
+    bool ready = false;
+    int level = 0;
+
+    ~deflate_context() {
+        if (ready) {
+            deflateEnd(&stream);
+        }
+    }
+};
+
+static bool deflateBody(std::string_view input, bool gzip, int level, std::string& output) {
+    thread_local deflate_context contexts[2];
+    deflate_context& context = contexts[gzip];
+    if (context.ready && context.level == level) {
+        deflateReset(&context.stream);
+    } else {
+        if (context.ready) {
+            deflateEnd(&context.stream);
+        }
+        context.stream = z_stream();
+        context.level = level;
+        context.ready = deflateInit2(&context.stream, level, Z_DEFLATED, gzip ? 31 : 15, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        if (!context.ready) {
+            return false;
+        }
+    }
+
+    output.resize(deflateBound(&context.stream, static_cast<uLong>(input.size())));
+    context.stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    context.stream.avail_in = static_cast<uInt>(input.size());
+    context.stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+    context.stream.avail_out = static_cast<uInt>(output.size());
+    if (deflate(&context.stream, Z_FINISH) != Z_STREAM_END) {
+        return false;
+    }
+    output.resize(context.stream.total_out);
+    return true;
+}
+
+#ifdef GHETTP_HAVE_BROTLI
+static bool brotliBody(std::string_view input, int quality, std::string& output) {
+    output.resize(BrotliEncoderMaxCompressedSize(input.size()));
+    size_t encoded_size = output.size();
+    if (output.empty() ||
+        !BrotliEncoderCompress(quality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, input.size(),
+                               reinterpret_cast<const uint8_t*>(input.data()), &encoded_size,
+                               reinterpret_cast<uint8_t*>(&output[0]))) {
+        return false;
+    }
+    output.resize(encoded_size);
+    return true;
+}
+#endif
+
+#ifdef GHETTP_HAVE_ZSTD
+static bool zstdBody(std::string_view input, int level, std::string& output) {
+    thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> context(ZSTD_createCCtx(), ZSTD_freeCCtx);
+    if (!context) {
+        return false;
+    }
+    output.resize(ZSTD_compressBound(input.size()));
+    size_t encoded_size = ZSTD_compressCCtx(context.get(), &output[0], output.size(), input.data(), input.size(), level);
+    if (ZSTD_isError(encoded_size)) {
+        return false;
+    }
+    output.resize(encoded_size);
+    return true;
+}
+#endif
+
+std::string_view codingName(content_coding coding) {
+    switch (coding) {
+        case content_coding::deflate: return "deflate";
+        case content_coding::gzip: return "gzip";
+        case content_coding::zstd: return "zstd";
+        case content_coding::brotli: return "br";
+        default: return "identity";
+    }
+}
+
+bool codingAvailable(content_coding coding) {
+    switch (coding) {
+        case content_coding::identity:
+        case content_coding::deflate:
+        case content_coding::gzip:
+            return true;
+#ifdef GHETTP_HAVE_ZSTD
+        case content_coding::zstd:
+            return true;
+#endif
+#ifdef GHETTP_HAVE_BROTLI
+        case content_coding::brotli:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+int acceptQuality(std::string_view accept_encoding, content_coding coding) {
+    std::string_view name = codingName(coding);
+    int wildcard = 0;
+    std::string_view item;
+    while (nextListItem(accept_encoding, item)) {
+        size_t semicolon = item.find(';');
+        std::string_view coding = trim(item.substr(0, semicolon));
+        int quality = 1000;
+        while (semicolon != std::string_view::npos) {
+            item.remove_prefix(semicolon + 1);
+            semicolon = item.find(';');
+            std::string_view parameter = trim(item.substr(0, semicolon));
+            if (parameter.size() >= 2 && (parameter[0] == 'q' || parameter[0] == 'Q') && parameter[1] == '=') {
+                quality = parseQuality(parameter.substr(2));
+            }
+        }
+
+        if (equalsIgnoreCase(coding, name)) {
+            return quality;
+        }
+        if (coding == "*") {
+            wildcard = quality;
+        }
+    }
+    return wildcard;
+}
+
+content_coding negotiateEncoding(std::string_view accept_encoding) {
+    static const content_coding preference[] = {
+        content_coding::brotli, content_coding::zstd, content_coding::gzip, content_coding::deflate,
+    };
+
+    content_coding best = content_coding::identity;
+    int best_quality = 0;
+    for (content_coding coding : preference) {
+        if (!codingAvailable(coding)) {
+            continue;
+        }
+        int quality = acceptQuality(accept_encoding, coding);
+        if (quality > best_quality) {
+            best = coding;
+            best_quality = quality;
+        }
+    }
+    return best;
+}
+
+bool compressibleType(std::string_view content_type, const compression_options& options) {
+    std::string_view media_type = trim(content_type.substr(0, content_type.find(';')));
+    for (const auto& type : options.types) {
+        if (!type.empty() && type.back() == '/') {
+            if (media_type.size() > type.size() && strncasecmp(media_type.data(), type.data(), type.size()) == 0) {
+                return true;
+            }
+        } else if (equalsIgnoreCase(media_type, type)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool compress(std::string_view input, content_coding coding, const compression_options& options, std::string& output) {
+    if (input.size() > UINT_MAX) {
+        return false;
+    }
+    switch (coding) {
+        case content_coding::deflate: return deflateBody(input, false, options.gzip_level, output);
+        case content_coding::gzip: return deflateBody(input, true, options.gzip_level, output);
+#ifdef GHETTP_HAVE_ZSTD
+        case content_coding::zstd: return zstdBody(input, options.zstd_level, output);
+#endif
+#ifdef GHETTP_HAVE_BROTLI
+        case content_coding::brotli: return brotliBody(input, options.brotli_quality, output);
+#endif
+        default: return false;
+    }
+}
+
+void applyCompression(const HttpRequestView& request, HttpResponse& response, const compression_options& options) {
+    if (!options.enabled || response.status_code != 200 || response.file || response.stream ||
+        response.body.size() < options.min_size || response.headers.count("Content-Encoding")) {
+        return;
+    }
+    auto content_type = response.headers.find("Content-Type");
+    if (content_type == response.headers.end() || !compressibleType(content_type->second, options)) {
+        return;
+    }
+    auto cache_control = response.headers.find("Cache-Control");
+    if (cache_control != response.headers.end() && containsToken(cache_control->second, "no-transform")) {
+        return;
+    }
+
+    std::string& vary = response.headers["Vary"];
+    if (vary.empty()) {
+        vary = "Accept-Encoding";
+    } else if (!containsToken(vary, "Accept-Encoding") && !containsToken(vary, "*")) {
+        vary += ", Accept-Encoding";
+    }
+
+    content_coding coding = negotiateEncoding(request.header("Accept-Encoding"));
+    if (coding == content_coding::identity) {
+        return;
+    }
+
+    std::string encoded;
+    if (!compress(response.body, coding, options, encoded) || encoded.size() >= response.body.size()) {
+        return;
+    }
+    response.body = std::move(encoded);
+    response.headers["Content-Encoding"] = std::string(codingName(coding));
+
+    auto etag = response.headers.find("ETag");
+    if (etag != response.headers.end() && etag->second.compare(0, 2, "W/") != 0) {
+        etag->second.insert(0, "W/");
+    }
+}
+
+}
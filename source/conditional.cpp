@@ -0,0 +1,102 @@
+#include "../include/conditional.hpp"
+#include "../include/file_cache.hpp"
+#include "../include/header_tokens.hpp"
+#include <cstdio>
+#include <functional>
+
+namespace ghettp {
+
+static std::string_view opaqueTag(std::string_view tag) {
+    if (tag.substr(0, 2) == "W/") {
+        tag.remove_prefix(2);
+    }
+    return tag;
+}
+
+std::string httpDate(time_t time) {
+    tm utc;
+    gmtime_r(&time, &utc);
+    char buffer[32];
+    size_t length = strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &utc);
+    return std::string(buffer, length);
+}
+
+bool parseHttpDate(std::string_view text, time_t& time) {
+    std::string value(trim(text));
+    tm utc{};
+    const char* end = strptime(value.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &utc);
+    if (!end || *end != '\0') {
+        return false;
+    }
+    time = timegm(&utc);
+    return true;
+}
+
+std::string entityTag(const HttpResponse& response) {
+    char buffer[64];
+    if (response.file) {
+        const static_file& file = *response.file;
+        snprintf(buffer, sizeof(buffer), "\"%lx-%lx%09lx-%zx\"", static_cast<unsigned long>(file.inode),
+                 static_cast<unsigned long>(file.modified.tv_sec), static_cast<unsigned long>(file.modified.tv_nsec),
+                 file.size);
+    } else {
+        snprintf(buffer, sizeof(buffer), "\"%016zx\"", std::hash<std::string_view>()(response.body));
+    }
+    return buffer;
+}
+
+bool tagListMatches(std::string_view list, std::string_view tag) {
+    list = trim(list);
+    if (list == "*") {
+        return true;
+    }
+
+    tag = opaqueTag(tag);
+    std::string_view candidate;
+    while (nextListItem(list, candidate)) {
+        if (opaqueTag(candidate) == tag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void addValidators(HttpResponse& response) {
+    if (response.headers.find("ETag") == response.headers.end()) {
+        response.headers["ETag"] = entityTag(response);
+    }
+    if (response.file && response.headers.find("Last-Modified") == response.headers.end()) {
+        response.headers["Last-Modified"] = httpDate(response.file->modified.tv_sec);
+    }
+}
+
+bool notModified(const HttpRequestView& request, const HttpResponse& response) {
+    std::string_view if_none_match = request.header("If-None-Match");
+    if (!if_none_match.empty()) {
+        auto etag = response.headers.find("ETag");
+        return etag != response.headers.end() && tagListMatches(if_none_match, etag->second);
+    }
+
+    std::string_view if_modified_since = request.header("If-Modified-Since");
+    auto last_modified = response.headers.find("Last-Modified");
+    if (if_modified_since.empty() || last_modified == response.headers.end()) {
+        return false;
+    }
+
+    time_t since;
+    time_t modified;
+    return parseHttpDate(if_modified_since, since) && parseHttpDate(last_modified->second, modified) &&
+           modified <= since;
+}
+
+void makeNotModified(HttpResponse& response) {
+    response.status_code = 304;
+    response.status_text.clear();
+    response.headers.erase("Content-Type");
+    response.body.clear();
+    response.file.reset();
+    response.file_offset = 0;
+    response.file_length = 0;
+}
+
+}
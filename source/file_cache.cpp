@@ -0,0 +1,253 @@
+#include "../include/file_cache.hpp"
+#include <fcntl.h>
+#include <linux/openat2.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <strings.h>
+#include <stdexcept>
+
+namespace ghettp {
+
+static const std::chrono::seconds revalidate_interval(1);
+
+static const std::pair<std::string_view, std::string_view> content_types[] = {
+    {"html", "text/html; charset=utf-8"},
+    {"htm", "text/html; charset=utf-8"},
+    {"css", "text/css; charset=utf-8"},
+    {"js", "text/javascript; charset=utf-8"},
+    {"mjs", "text/javascript; charset=utf-8"},
+    {"json", "application/json"},
+    {"map", "application/json"},
+    {"txt", "text/plain; charset=utf-8"},
+    {"csv", "text/csv; charset=utf-8"},
+    {"xml", "application/xml"},
+    {"svg", "image/svg+xml"},
+    {"png", "image/png"},
+    {"jpg", "image/jpeg"},
+    {"jpeg", "image/jpeg"},
+    {"gif", "image/gif"},
+    {"webp", "image/webp"},
+    {"avif", "image/avif"},
+    {"ico", "image/x-icon"},
+    {"woff", "font/woff"},
+    {"woff2", "font/woff2"},
+    {"ttf", "font/ttf"},
+    {"otf", "font/otf"},
+    {"wasm", "application/wasm"},
+    {"pdf", "application/pdf"},
+    {"zip", "application/zip"},
+    {"gz", "application/gzip"},
+    {"tar", "application/x-tar"},
+    {"mp4", "video/mp4"},
+    {"webm", "video/webm"},
+    {"mp3", "audio/mpeg"},
+    {"ogg", "audio/ogg"},
+    {"wav", "audio/wav"},
+};
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static_file::~static_file() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+std::string_view contentType(std::string_view path) {
+    size_t slash = path.rfind('/');
+    size_t dot = path.rfind('.');
+    if (dot != std::string_view::npos && (slash == std::string_view::npos || dot > slash)) {
+        std::string_view extension = path.substr(dot + 1);
+        for (const auto& type : content_types) {
+            if (type.first.size() == extension.size() &&
+                strncasecmp(type.first.data(), extension.data(), extension.size()) == 0) {
+                return type.second;
+            }
+        }
+    }
+    return "application/octet-stream";
+}
+
+bool normalizePath(std::string_view path, std::string& out) {
+    out.clear();
+    std::string segment;
+    for (size_t i = 0; i <= path.size(); ++i) {
+        if (i == path.size() || path[i] == '/') {
+            if (segment == "..") {
+                return false;
+            }
+            if (!segment.empty() && segment != ".") {
+                if (!out.empty()) {
+                    out.push_back('/');
+                }
+                out += segment;
+            }
+            segment.clear();
+            continue;
+        }
+
+        char c = path[i];
+        if (c == '%') {
+            if (i + 2 >= path.size()) {
+                return false;
+            }
+            int high = hexValue(path[i + 1]);
+            int low = hexValue(path[i + 2]);
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            c = static_cast<char>(high * 16 + low);
+            i += 2;
+        }
+        if (c == '\0' || c == '/' || c == '\\') {
+            return false;
+        }
+        segment.push_back(c);
+    }
+    return true;
+}
+
+file_cache::file_cache(const std::string& directory, size_t capacity)
+    : m_directory_fd(::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)), m_capacity(capacity) {
+    if (m_directory_fd < 0) {
+        throw std::runtime_error("Failed to open static directory " + directory);
+    }
+}
+
+file_cache::~file_cache() {
+    close(m_directory_fd);
+}
+
+static int openBeneath(int directory_fd, const std::string& name) {
+    open_how how{};
+    how.flags = O_RDONLY | O_CLOEXEC;
+    how.resolve = RESOLVE_BENEATH | RESOLVE_NO_MAGICLINKS;
+    int fd = static_cast<int>(syscall(SYS_openat2, directory_fd, name.c_str(), &how, sizeof(how)));
+    if (fd >= 0 || errno != ENOSYS) {
+        return fd;
+    }
+
+    int parent = directory_fd;
+    size_t start = 0;
+    while (true) {
+        size_t end = name.find('/', start);
+        std::string component = name.substr(start, end - start);
+        int flags = O_RDONLY | O_CLOEXEC | O_NOFOLLOW | (end == std::string::npos ? 0 : O_DIRECTORY);
+        fd = openat(parent, component.c_str(), flags);
+        if (parent != directory_fd) {
+            close(parent);
+        }
+        if (fd < 0 || end == std::string::npos) {
+            return fd;
+        }
+        parent = fd;
+        start = end + 1;
+    }
+}
+
+static std::shared_ptr<static_file> openRegular(int directory_fd, const std::string& name) {
+    int fd = openBeneath(directory_fd, name);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    auto file = std::make_shared<static_file>();
+    file->fd = fd;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return nullptr;
+    }
+    file->size = static_cast<size_t>(info.st_size);
+    file->inode = info.st_ino;
+    file->modified = info.st_mtim;
+    return file;
+}
+
+static bool unchanged(int directory_fd, const std::string& name, const static_file* file) {
+    struct stat info;
+    if (fstatat(directory_fd, name.c_str(), &info, 0) != 0) {
+        return !file;
+    }
+    return file && info.st_ino == file->inode && static_cast<size_t>(info.st_size) == file->size &&
+           info.st_mtim.tv_sec == file->modified.tv_sec && info.st_mtim.tv_nsec == file->modified.tv_nsec;
+}
+
+std::string file_cache::resolve(const std::string& path) const {
+    std::string name = path.empty() ? "." : path;
+    struct stat info;
+    if (fstatat(m_directory_fd, name.c_str(), &info, 0) == 0 && S_ISDIR(info.st_mode)) {
+        name = path.empty() ? "index.html" : path + "/index.html";
+    }
+    return name;
+}
+
+std::shared_ptr<const static_file> file_cache::load(const std::string& path) const {
+    std::string name = resolve(path);
+    std::shared_ptr<static_file> file = openRegular(m_directory_fd, name);
+    if (!file) {
+        return nullptr;
+    }
+    file->content_type = contentType(name);
+    file->gzip = openRegular(m_directory_fd, name + ".gz");
+    file->brotli = openRegular(m_directory_fd, name + ".br");
+    return file;
+}
+
+bool file_cache::current(const entry& cached) const {
+    std::string name = resolve(cached.path);
+    const static_file& file = *cached.file;
+    return unchanged(m_directory_fd, name, &file) && unchanged(m_directory_fd, name + ".gz", file.gzip.get()) &&
+           unchanged(m_directory_fd, name + ".br", file.brotli.get());
+}
+
+std::shared_ptr<const static_file> file_cache::open(const std::string& path) {
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_index.find(path);
+        if (found != m_index.end()) {
+            auto position = found->second;
+            if (now - position->checked < revalidate_interval || current(*position)) {
+                position->checked = now;
+                m_entries.splice(m_entries.begin(), m_entries, position);
+                return position->file;
+            }
+            m_index.erase(found);
+            m_entries.erase(position);
+        }
+    }
+
+    std::shared_ptr<const static_file> file = load(path);
+    if (!file || m_capacity == 0) {
+        return file;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_index.find(path);
+    if (found != m_index.end()) {
+        m_entries.erase(found->second);
+        m_index.erase(found);
+    }
+    m_entries.push_front(entry{path, file, now});
+    m_index.emplace(m_entries.front().path, m_entries.begin());
+    if (m_entries.size() > m_capacity) {
+        m_index.erase(m_entries.back().path);
+        m_entries.pop_back();
+    }
+    return file;
+}
+
+}
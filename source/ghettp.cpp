@@ -1,39 +1,170 @@
 #include "../include/ghettp.hpp"
+#include "../include/http_parser.hpp"
+#include "../include/file_cache.hpp"
+#include "../include/conditional.hpp"
+#include "../include/range.hpp"
+#include "../include/compression.hpp"
+#include "../include/response_cache.hpp"
+#include "../include/single_flight.hpp"
+#include <charconv>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace ghettp {
 
-server::server(int port) : m_socket(port) {
-    m_socket.setRequestHandler([this](const HttpRequest& req) {
+static RequestViewHandler owning(const RequestHandler& handler) {
+    return [handler](const HttpRequestView& request) {
+        return handler(request.toRequest());
+    };
+}
+
+struct spool_file {
+    int fd = -1;
+    std::string path;
+
+    ~spool_file() {
+        if (fd >= 0) {
+            close(fd);
+            unlink(path.c_str());
+        }
+    }
+};
+
+static bool exceedsSpoolThreshold(const HttpRequestView& request, size_t threshold) {
+    if (threshold == 0) {
+        return false;
+    }
+    if (!request.header("Transfer-Encoding").empty()) {
+        return true;
+    }
+    std::string_view header = request.header("Content-Length");
+    size_t length = 0;
+    std::from_chars(header.data(), header.data() + header.size(), length);
+    return length > threshold;
+}
+
+static HttpResponse notFound() {
+    return server::html("<html><body><h1>404 - Not Found</h1></body></html>", 404);
+}
+
+static HttpResponse staticResponse(file_cache& cache, const HttpRequestView& request) {
+    std::string path;
+    if (!normalizePath(request.param("path"), path)) {
+        return notFound();
+    }
+
+    std::shared_ptr<const static_file> file = cache.open(path);
+    if (!file) {
+        return notFound();
+    }
+
+    HttpResponse response;
+    response.headers["Content-Type"] = std::string(file->content_type);
+    response.file = file;
+    if (file->gzip || file->brotli) {
+        response.headers["Vary"] = "Accept-Encoding";
+        std::string_view accept_encoding = request.header("Accept-Encoding");
+        int brotli = file->brotli ? acceptQuality(accept_encoding, content_coding::brotli) : 0;
+        int gzip = file->gzip ? acceptQuality(accept_encoding, content_coding::gzip) : 0;
+        if (brotli > 0 && brotli >= gzip) {
+            response.headers["Content-Encoding"] = "br";
+            response.file = file->brotli;
+        } else if (gzip > 0) {
+            response.headers["Content-Encoding"] = "gzip";
+            response.file = file->gzip;
+        }
+    }
+    response.file_length = response.file->size;
+    return response;
+}
+
+server::server(int port, const server_options& options)
+    : m_socket(port, options), m_options(options), m_cache(options.response_cache_bytes) {
+    m_socket.setRequestHandler([this](HttpRequestView& req) {
         return routeRequest(req);
     });
+    m_socket.setBodyHandler([this](HttpRequestView& req, BodyReader& reader) {
+        return routeBody(req, reader);
+    });
 }
 
 server::~server() {
     stop();
 }
 
-void server::get(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler) {
-    m_routes["GET"][path] = handler;
+void server::get(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler,
+                 const route_options& options) {
+    get(path, owning(handler), options);
+}
+
+void server::post(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler,
+                  const route_options& options) {
+    post(path, owning(handler), options);
 }
 
-void server::post(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler) {
-    m_routes["POST"][path] = handler;
+void server::put(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler,
+                 const route_options& options) {
+    put(path, owning(handler), options);
 }
 
-void server::put(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler) {
-    m_routes["PUT"][path] = handler;
+void server::del(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler,
+                 const route_options& options) {
+    del(path, owning(handler), options);
 }
 
-void server::del(const std::string& path, std::function<HttpResponse(const HttpRequest&)> handler) {
-    m_routes["DELETE"][path] = handler;
+void server::get(const std::string& path, RequestViewHandler handler, const route_options& options) {
+    m_routes[static_cast<size_t>(http_method::get)].add(path, route{handler, options, nullptr});
+    m_body_routes[static_cast<size_t>(http_method::get)] |= options.spool_threshold > 0;
+}
+
+void server::post(const std::string& path, RequestViewHandler handler, const route_options& options) {
+    m_routes[static_cast<size_t>(http_method::post)].add(path, route{handler, options, nullptr});
+    m_body_routes[static_cast<size_t>(http_method::post)] |= options.spool_threshold > 0;
+}
+
+void server::put(const std::string& path, RequestViewHandler handler, const route_options& options) {
+    m_routes[static_cast<size_t>(http_method::put)].add(path, route{handler, options, nullptr});
+    m_body_routes[static_cast<size_t>(http_method::put)] |= options.spool_threshold > 0;
+}
+
+void server::del(const std::string& path, RequestViewHandler handler, const route_options& options) {
+    m_routes[static_cast<size_t>(http_method::del)].add(path, route{handler, options, nullptr});
+    m_body_routes[static_cast<size_t>(http_method::del)] |= options.spool_threshold > 0;
+}
+
+void server::post(const std::string& path, StreamingHandler handler, const route_options& options) {
+    m_routes[static_cast<size_t>(http_method::post)].add(path, route{nullptr, options, handler});
+    m_body_routes[static_cast<size_t>(http_method::post)] = true;
+}
+
+void server::put(const std::string& path, StreamingHandler handler, const route_options& options) {
+    m_routes[static_cast<size_t>(http_method::put)].add(path, route{nullptr, options, handler});
+    m_body_routes[static_cast<size_t>(http_method::put)] = true;
+}
+
+void server::serve_static(const std::string& prefix, const std::string& directory) {
+    auto cache = std::make_shared<file_cache>(directory, m_options.static_cache_entries);
+    std::string base = prefix;
+    while (!base.empty() && base.back() == '/') {
+        base.pop_back();
+    }
+
+    route_options options;
+    options.conditional = true;
+    options.ranges = true;
+    get(base + "/*path", [cache](const HttpRequestView& request) {
+        return staticResponse(*cache, request);
+    }, options);
 }
 
 HttpResponse server::html(const std::string& content, int status_code) {
     HttpResponse response;
     response.status_code = status_code;
-    response.status_text = (status_code == 200) ? "OK" : "Error";
     response.headers["Content-Type"] = "text/html";
     response.body = content;
     return response;
@@ -42,7 +173,6 @@ HttpResponse server::html(const std::string& content, int status_code) {
 HttpResponse server::json(const std::string& content, int status_code) {
     HttpResponse response;
     response.status_code = status_code;
-    response.status_text = (status_code == 200) ? "OK" : "Error";
     response.headers["Content-Type"] = "application/json";
     response.body = content;
     return response;
@@ -51,16 +181,26 @@ HttpResponse server::json(const std::string& content, int status_code) {
 HttpResponse server::text(const std::string& content, int status_code) {
     HttpResponse response;
     response.status_code = status_code;
-    response.status_text = (status_code == 200) ? "OK" : "Error";
     response.headers["Content-Type"] = "text/plain";
     response.body = content;
     return response;
 }
 
-void server::start() {
+HttpResponse server::stream(ResponseStream producer, const std::string& content_type) {
+    HttpResponse response;
+    response.headers["Content-Type"] = content_type;
+    response.stream = std::move(producer);
+    return response;
+}
+
+cache_counters server::cache_stats() const {
+    return m_cache.counters();
+}
+
+void server::start(io_model model) {
     m_running = true;
-    m_server_thread = std::thread([this]() {
-        m_socket.run();
+    m_server_thread = std::thread([this, model]() {
+        m_socket.run(model);
     });
 }
 
@@ -74,21 +214,147 @@ void server::stop() {
     }
 }
 
-HttpResponse server::routeRequest(const HttpRequest& request) {
-    auto method_routes = m_routes.find(request.method);
-    if (method_routes != m_routes.end()) {
-        auto route = method_routes->second.find(request.path);
-        if (route != method_routes->second.end()) {
-            return route->second(request);
+bool server::routeBody(HttpRequestView& request, BodyReader& reader) {
+    if (request.method_id == http_method::unknown || !m_body_routes[static_cast<size_t>(request.method_id)]) {
+        return false;
+    }
+
+    const router& routes = m_routes[static_cast<size_t>(request.method_id)];
+    const route* target = routes.find(request.path, request.params);
+    if (!target) {
+        return false;
+    }
+    if (!target->streaming) {
+        return exceedsSpoolThreshold(request, target->options.spool_threshold) && spoolBody(*target, routes, reader);
+    }
+
+    reader = target->streaming(request);
+    RequestDispatcher complete = std::move(reader.on_complete);
+    reader.on_complete = [this, target, &routes, complete](HttpRequestView& request) {
+        routes.find(request.path, request.params);
+        HttpResponse response = complete(request);
+        finishResponse(*target, request, response);
+        return response;
+    };
+    return true;
+}
+
+bool server::spoolBody(const route& target, const router& routes, BodyReader& reader) {
+    auto spool = std::make_shared<spool_file>();
+    spool->path = m_options.spool_directory + "/ghettp-XXXXXX";
+    spool->fd = mkostemp(&spool->path[0], O_CLOEXEC);
+    if (spool->fd < 0) {
+        throw std::runtime_error("Failed to create spool file in " + m_options.spool_directory);
+    }
+
+    reader.spool_fd = spool->fd;
+    reader.on_data = [spool](std::string_view chunk) {
+        while (!chunk.empty()) {
+            ssize_t written = write(spool->fd, chunk.data(), chunk.size());
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                throw std::runtime_error("Failed to write spool file");
+            }
+            chunk.remove_prefix(written);
+        }
+    };
+    reader.on_complete = [this, &target, &routes, spool](HttpRequestView& request) {
+        routes.find(request.path, request.params);
+        lseek(spool->fd, 0, SEEK_SET);
+        request.body = {};
+        request.body_fd = spool->fd;
+        request.body_path = spool->path;
+        HttpResponse response = target.handler(request);
+        finishResponse(target, request, response);
+        return response;
+    };
+    return true;
+}
+
+void server::finishResponse(const route& target, const HttpRequestView& request, HttpResponse& response) const {
+    if (response.stream) {
+        return;
+    }
+    if (target.options.conditional && response.status_code == 200) {
+        addValidators(response);
+        if (notModified(request, response)) {
+            makeNotModified(response);
+        }
+    }
+    if (target.options.ranges) {
+        applyRange(request, response);
+    }
+    if (target.options.compress) {
+        applyCompression(request, response, m_options.compression);
+    }
+}
+
+const route* server::findRoute(http_method method, HttpRequestView& request) const {
+    const route* target = m_routes[static_cast<size_t>(method)].find(request.path, request.params);
+    if (!target && method == http_method::head) {
+        target = m_routes[static_cast<size_t>(http_method::get)].find(request.path, request.params);
+    }
+    return target;
+}
+
+HttpResponse server::routeRequest(HttpRequestView& request) {
+    if (request.method_id != http_method::unknown) {
+        const route* target = findRoute(request.method_id, request);
+        if (target) {
+            bool cached = target->options.cache_ttl.count() > 0 && cacheableRequest(request) &&
+                          !(target->options.conditional &&
+                            (!request.header("If-None-Match").empty() || !request.header("If-Modified-Since").empty())) &&
+                          !(target->options.ranges && !request.header("Range").empty());
+            if (cached) {
+                HttpResponse response;
+                response.serialized = m_cache.find(request);
+                if (response.serialized) {
+                    return response;
+                }
+            }
+
+            bool coalesced = target->options.coalesce && cacheableRequest(request);
+            HttpResponse response = coalesced ? m_flights.run(request, [&]() { return target->handler(request); })
+                                              : target->handler(request);
+            finishResponse(*target, request, response);
+            if (cached && cacheableResponse(response)) {
+                response.serialized = m_socket.serialize(response);
+                m_cache.store(request, response, response.serialized, target->options.cache_ttl);
+            }
+            return response;
         }
     }
 
     HttpResponse response;
-    response.status_code = 404;
-    response.status_text = "Not Found";
     response.headers["Content-Type"] = "text/html";
-    response.body = "<html><body><h1>404 - Not Found</h1></body></html>";
-    return response;
+
+    if (request.method_id == http_method::unknown) {
+        response.status_code = 501;
+        response.body = "<html><body><h1>501 - Not Implemented</h1></body></html>";
+        return response;
+    }
+
+    std::string allow;
+    for (size_t method = 0; method < http_method_count; ++method) {
+        if (findRoute(static_cast<http_method>(method), request)) {
+            if (!allow.empty()) {
+                allow += ", ";
+            }
+            allow += methodName(static_cast<http_method>(method));
+        }
+    }
+    request.params.clear();
+
+    if (!allow.empty()) {
+        response.status_code = 405;
+        response.headers["Allow"] = allow;
+        response.body = "<html><body><h1>405 - Method Not Allowed</h1></body></html>";
+        return response;
+    }
+
+    return notFound();
 }
 
 }
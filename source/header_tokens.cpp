@@ -0,0 +1,40 @@
+#include "../include/header_tokens.hpp"
+#include <strings.h>
+
+namespace ghettp {
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+        value.remove_suffix(1);
+    }
+    return value;
+}
+
+bool equalsIgnoreCase(std::string_view left, std::string_view right) {
+    return left.size() == right.size() && strncasecmp(left.data(), right.data(), left.size()) == 0;
+}
+
+bool nextListItem(std::string_view& list, std::string_view& item) {
+    if (list.empty()) {
+        return false;
+    }
+    size_t comma = list.find(',');
+    item = trim(list.substr(0, comma));
+    list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+    return true;
+}
+
+bool containsToken(std::string_view list, std::string_view token) {
+    std::string_view item;
+    while (nextListItem(list, item)) {
+        if (equalsIgnoreCase(item, token)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,367 @@
+#include "../include/http_parser.hpp"
+#include "../include/http_scan.hpp"
+#include <algorithm>
+#include <cstring>
+#include <strings.h>
+
+namespace ghettp {
+
+http_method parseMethod(const char* data, size_t length) {
+    switch (length) {
+        case 3:
+            if (memcmp(data, "GET", 3) == 0) return http_method::get;
+            if (memcmp(data, "PUT", 3) == 0) return http_method::put;
+            break;
+        case 4:
+            if (memcmp(data, "POST", 4) == 0) return http_method::post;
+            if (memcmp(data, "HEAD", 4) == 0) return http_method::head;
+            break;
+        case 5:
+            if (memcmp(data, "PATCH", 5) == 0) return http_method::patch;
+            if (memcmp(data, "TRACE", 5) == 0) return http_method::trace;
+            break;
+        case 6:
+            if (memcmp(data, "DELETE", 6) == 0) return http_method::del;
+            break;
+        case 7:
+            if (memcmp(data, "OPTIONS", 7) == 0) return http_method::options;
+            if (memcmp(data, "CONNECT", 7) == 0) return http_method::connect;
+            break;
+    }
+    return http_method::unknown;
+}
+
+std::string_view methodName(http_method method) {
+    static const std::string_view names[] = {
+        "GET", "HEAD", "POST", "PUT", "DELETE", "PATCH", "OPTIONS", "TRACE", "CONNECT", ""
+    };
+    return names[static_cast<size_t>(method)];
+}
+
+http_parser::http_parser(size_t max_header_size, size_t max_body_size)
+    : m_max_header_size(max_header_size), m_max_body_size(max_body_size) {
+}
+
+void http_parser::reset() {
+    m_state = state::request_line;
+    m_offset = 0;
+    m_content_length = 0;
+    m_body_end = 0;
+    m_chunk_remaining = 0;
+    m_trailer_size = 0;
+    m_consumed = 0;
+    m_error_status = 0;
+    m_has_length = false;
+    m_chunked = false;
+    m_streaming = false;
+    method_id = http_method::unknown;
+    method = span();
+    path = span();
+    query = span();
+    version = span();
+    headers.clear();
+    body = span();
+}
+
+http_parser::result http_parser::fail(int status_code) {
+    m_error_status = status_code;
+    return result::error;
+}
+
+http_parser::result http_parser::parse(char* data, size_t size) {
+    const char* limit = data + size;
+
+    while (m_state == state::request_line || m_state == state::header_line) {
+        const char* line = data + m_offset;
+        const char* line_end;
+        const char* name_end = line;
+        const char* value = line;
+        const char* value_end = line;
+
+        if (m_state == state::request_line) {
+            line_end = findValueEnd(line, limit);
+        } else if (line < limit && *line != '\r' && *line != '\n') {
+            name_end = findTokenEnd(line, limit);
+            if (name_end == limit) {
+                return incomplete(size);
+            }
+            if (name_end == line || *name_end != ':') {
+                return fail(400);
+            }
+
+            value = name_end + 1;
+            while (value < limit && (*value == ' ' || *value == '\t')) {
+                ++value;
+            }
+            line_end = findValueEnd(value, limit);
+            value_end = line_end;
+            while (value_end > value && (value_end[-1] == ' ' || value_end[-1] == '\t')) {
+                --value_end;
+            }
+        } else {
+            line_end = line;
+        }
+
+        if (line_end == limit || (*line_end == '\r' && line_end + 1 == limit)) {
+            return incomplete(size);
+        }
+        const char* next = line_end + 1;
+        if (*line_end == '\r') {
+            if (*next != '\n') {
+                return fail(400);
+            }
+            ++next;
+        } else if (*line_end != '\n') {
+            return fail(400);
+        }
+
+        m_offset = next - data;
+        if (m_offset > m_max_header_size) {
+            return fail(431);
+        }
+
+        if (m_state == state::request_line) {
+            if (line_end == line) {
+                continue;
+            }
+            if (!parseRequestLine(line, line_end - line)) {
+                return fail(400);
+            }
+            size_t start = line - data;
+            method.offset += start;
+            path.offset += start;
+            query.offset += start;
+            version.offset += start;
+            m_state = state::header_line;
+        } else if (line_end != line) {
+            if (!addHeader(data, line - data, name_end - line, value - data, value_end - value)) {
+                return fail(400);
+            }
+        } else {
+            if (m_chunked && m_has_length) {
+                return fail(400);
+            }
+            body.offset = m_offset;
+            m_body_end = m_offset;
+            m_state = m_chunked ? state::chunk_size : state::body;
+            return result::head;
+        }
+    }
+
+    if (m_state == state::complete) {
+        return result::complete;
+    }
+    result status = m_state == state::body ? parseBody(size) : parseChunked(data, size);
+    if (status == result::complete) {
+        body.length = m_body_end - body.offset;
+        m_consumed = m_offset;
+        m_state = state::complete;
+    }
+    return status;
+}
+
+bool http_parser::checkBodySize(size_t length) {
+    return m_streaming || length <= m_max_body_size;
+}
+
+http_parser::result http_parser::parseBody(size_t size) {
+    if (!checkBodySize(m_body_end - body.offset + m_content_length)) {
+        return fail(413);
+    }
+
+    size_t take = std::min(size - m_offset, m_content_length);
+    m_offset += take;
+    m_body_end += take;
+    m_content_length -= take;
+    return m_content_length == 0 ? result::complete : result::incomplete;
+}
+
+http_parser::result http_parser::parseChunked(char* data, size_t size) {
+    while (true) {
+        if (m_state == state::chunk_size || m_state == state::trailer) {
+            const char* line = data + m_offset;
+            const char* line_end = static_cast<const char*>(memchr(line, '\n', size - m_offset));
+            size_t line_limit = m_state == state::chunk_size ? 1024 : m_max_header_size - m_trailer_size;
+            if (!line_end) {
+                if (size - m_offset > line_limit) {
+                    return fail(m_state == state::chunk_size ? 400 : 431);
+                }
+                return result::incomplete;
+            }
+
+            size_t line_length = line_end - line;
+            if (line_length > line_limit) {
+                return fail(m_state == state::chunk_size ? 400 : 431);
+            }
+            m_offset += line_length + 1;
+            if (line_length > 0 && line[line_length - 1] == '\r') {
+                --line_length;
+            }
+
+            if (m_state == state::trailer) {
+                m_trailer_size += line_length;
+                if (line_length == 0) {
+                    return result::complete;
+                }
+                continue;
+            }
+
+            size_t chunk_size = 0;
+            size_t digits = 0;
+            for (; digits < line_length; ++digits) {
+                char c = line[digits];
+                int value = c >= '0' && c <= '9' ? c - '0'
+                          : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                          : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+                if (value < 0) {
+                    break;
+                }
+                if (digits == 15) {
+                    return fail(400);
+                }
+                chunk_size = chunk_size * 16 + value;
+            }
+            if (digits == 0 || (digits < line_length && line[digits] != ';' && line[digits] != ' ' &&
+                                line[digits] != '\t')) {
+                return fail(400);
+            }
+
+            if (chunk_size == 0) {
+                m_state = state::trailer;
+                continue;
+            }
+            if (!checkBodySize(m_body_end - body.offset + chunk_size)) {
+                return fail(413);
+            }
+            m_chunk_remaining = chunk_size;
+            m_state = state::chunk_data;
+        }
+
+        if (m_state == state::chunk_data) {
+            size_t take = std::min(size - m_offset, m_chunk_remaining);
+            if (m_body_end != m_offset) {
+                memmove(data + m_body_end, data + m_offset, take);
+            }
+            m_offset += take;
+            m_body_end += take;
+            m_chunk_remaining -= take;
+            if (m_chunk_remaining > 0) {
+                return result::incomplete;
+            }
+            m_state = state::chunk_end;
+        }
+
+        if (m_offset == size) {
+            return result::incomplete;
+        }
+        if (data[m_offset] == '\r') {
+            if (m_offset + 1 == size) {
+                return result::incomplete;
+            }
+            ++m_offset;
+        }
+        if (data[m_offset] != '\n') {
+            return fail(400);
+        }
+        ++m_offset;
+        m_state = state::chunk_size;
+    }
+}
+
+size_t http_parser::releaseBody(char* data, size_t size) {
+    size_t released = m_offset - body.offset;
+    memmove(data + body.offset, data + m_offset, size - m_offset);
+    m_offset = body.offset;
+    m_body_end = body.offset;
+    if (m_state == state::complete) {
+        body.length = 0;
+        m_consumed = m_offset;
+    }
+    return size - released;
+}
+
+http_parser::result http_parser::incomplete(size_t size) {
+    if (size > m_max_header_size) {
+        return fail(431);
+    }
+    return result::incomplete;
+}
+
+bool http_parser::parseRequestLine(const char* line, size_t length) {
+    const char* end = line + length;
+    const char* method_end = findTokenEnd(line, end);
+    if (method_end == line || method_end == end || *method_end != ' ') {
+        return false;
+    }
+
+    const char* path_start = method_end + 1;
+    const char* path_end = static_cast<const char*>(memchr(path_start, ' ', end - path_start));
+    if (!path_end || path_end == path_start) {
+        return false;
+    }
+
+    const char* version_start = path_end + 1;
+    if (end - version_start < 5 || memcmp(version_start, "HTTP/", 5) != 0) {
+        return false;
+    }
+
+    const char* query_start = static_cast<const char*>(memchr(path_start, '?', path_end - path_start));
+    const char* target_end = query_start ? query_start : path_end;
+
+    method_id = parseMethod(line, method_end - line);
+    method = {0, static_cast<size_t>(method_end - line)};
+    path = {static_cast<size_t>(path_start - line), static_cast<size_t>(target_end - path_start)};
+    if (query_start) {
+        query = {static_cast<size_t>(query_start + 1 - line), static_cast<size_t>(path_end - query_start - 1)};
+    }
+    version = {static_cast<size_t>(version_start - line), static_cast<size_t>(end - version_start)};
+    return true;
+}
+
+bool http_parser::addHeader(const char* data, size_t name_offset, size_t name_length,
+                            size_t value_offset, size_t value_length) {
+    header_span header;
+    header.name = {name_offset, name_length};
+    header.value = {value_offset, value_length};
+    headers.push_back(header);
+
+    if (name_length == 17 && strncasecmp(data + name_offset, "Transfer-Encoding", 17) == 0) {
+        if (m_chunked || value_length != 7 || strncasecmp(data + value_offset, "chunked", 7) != 0) {
+            return false;
+        }
+        m_chunked = true;
+    } else if (name_length == 14 && strncasecmp(data + name_offset, "Content-Length", 14) == 0) {
+        if (m_has_length || value_length == 0 || value_length > 19) {
+            return false;
+        }
+        m_has_length = true;
+        size_t length = 0;
+        for (size_t i = value_offset; i < value_offset + value_length; ++i) {
+            if (data[i] < '0' || data[i] > '9') {
+                return false;
+            }
+            length = length * 10 + (data[i] - '0');
+        }
+        m_content_length = length;
+    }
+    return true;
+}
+
+void http_parser::view(const char* data, HttpRequestView& request) const {
+    request.method = std::string_view(data + method.offset, method.length);
+    request.method_id = method_id;
+    request.path = std::string_view(data + path.offset, path.length);
+    request.query = std::string_view(data + query.offset, query.length);
+    request.version = std::string_view(data + version.offset, version.length);
+    request.headers.clear();
+    for (const auto& header : headers) {
+        request.headers.emplace_back(std::string_view(data + header.name.offset, header.name.length),
+                                     std::string_view(data + header.value.offset, header.value.length));
+    }
+    request.params.clear();
+    request.body = std::string_view(data + body.offset, body.length);
+    request.body_fd = -1;
+    request.body_path = {};
+}
+
+}
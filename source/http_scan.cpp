@@ -0,0 +1,149 @@
+#include "../include/http_scan.hpp"
+#include <immintrin.h>
+#include <cstring>
+
+namespace ghettp {
+
+static const bool token_chars[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 1, 0, 1, 1, 1, 1, 1, 0, 0, 1, 1, 0, 1, 1, 0,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 0, 1, 0,
+};
+
+static inline bool isValueChar(unsigned char c) {
+    return c >= 0x20 ? c != 0x7f : c == '\t';
+}
+
+static const char* findTokenEndScalar(const char* begin, const char* end) {
+    while (begin < end && token_chars[static_cast<unsigned char>(*begin)]) {
+        ++begin;
+    }
+    return begin;
+}
+
+static const char* findValueEndScalar(const char* begin, const char* end) {
+    while (begin < end && isValueChar(static_cast<unsigned char>(*begin))) {
+        ++begin;
+    }
+    return begin;
+}
+
+__attribute__((target("sse4.2")))
+static const char* findTokenEndSse42(const char* begin, const char* end) {
+    alignas(16) static const char ranges[16] = {
+        '\x00', ' ', '"', '"', '(', ')', ',', ',', '/', '/', ':', '@', '[', ']', '{', '\xff'
+    };
+    const __m128i ranges16 = _mm_load_si128(reinterpret_cast<const __m128i*>(ranges));
+
+    while (end - begin >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        int index = _mm_cmpestri(ranges16, 16, chunk, 16,
+                                 _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_POSITIVE_POLARITY);
+        if (index == 16) {
+            begin += 16;
+            continue;
+        }
+        begin += index;
+        if (!token_chars[static_cast<unsigned char>(*begin)]) {
+            return begin;
+        }
+        ++begin;
+    }
+    return findTokenEndScalar(begin, end);
+}
+
+__attribute__((target("sse4.2")))
+static const char* findValueEndSse42(const char* begin, const char* end) {
+    alignas(16) static const char ranges[16] = {
+        '\x00', '\x08', '\x0a', '\x1f', '\x7f', '\x7f'
+    };
+    const __m128i ranges16 = _mm_load_si128(reinterpret_cast<const __m128i*>(ranges));
+
+    while (end - begin >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        int index = _mm_cmpestri(ranges16, 6, chunk, 16,
+                                 _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_POSITIVE_POLARITY);
+        if (index != 16) {
+            return begin + index;
+        }
+        begin += 16;
+    }
+    return findValueEndScalar(begin, end);
+}
+
+__attribute__((target("avx2")))
+static const char* findValueEndAvx2(const char* begin, const char* end) {
+    const __m256i control_max = _mm256_set1_epi8(0x1f);
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i del = _mm256_set1_epi8(0x7f);
+
+    while (end - begin >= 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control_max), chunk);
+        control = _mm256_andnot_si256(_mm256_cmpeq_epi8(chunk, tab), control);
+        control = _mm256_or_si256(control, _mm256_cmpeq_epi8(chunk, del));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(control));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 32;
+    }
+    return findValueEndSse42(begin, end);
+}
+
+struct scanner {
+    const char* name;
+    const char* (*token_end)(const char*, const char*);
+    const char* (*value_end)(const char*, const char*);
+    bool (*supported)();
+};
+
+static const scanner scanners[] = {
+    {"avx2", findTokenEndSse42, findValueEndAvx2,
+     []() { return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("sse4.2"); }},
+    {"sse4.2", findTokenEndSse42, findValueEndSse42,
+     []() { return static_cast<bool>(__builtin_cpu_supports("sse4.2")); }},
+    {"scalar", findTokenEndScalar, findValueEndScalar,
+     []() { return true; }},
+};
+
+static const scanner* detectScanner() {
+    __builtin_cpu_init();
+    for (const auto& candidate : scanners) {
+        if (candidate.supported()) {
+            return &candidate;
+        }
+    }
+    return &scanners[2];
+}
+
+static const scanner* active_scanner = detectScanner();
+
+const char* findTokenEnd(const char* begin, const char* end) {
+    return active_scanner->token_end(begin, end);
+}
+
+const char* findValueEnd(const char* begin, const char* end) {
+    return active_scanner->value_end(begin, end);
+}
+
+const char* scanImplementation() {
+    return active_scanner->name;
+}
+
+bool useScanImplementation(const char* name) {
+    for (const auto& candidate : scanners) {
+        if (strcmp(candidate.name, name) == 0 && candidate.supported()) {
+            active_scanner = &candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+}
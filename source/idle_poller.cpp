@@ -0,0 +1,165 @@
+#include "../include/idle_poller.hpp"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <stdexcept>
+#include <vector>
+
+namespace ghettp {
+
+idle_poller::idle_poller(std::chrono::milliseconds idle_timeout, std::function<void(int)> resume)
+    : m_timeout(idle_timeout), m_resume(std::move(resume)) {
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epoll_fd < 0 || m_wake_fd < 0) {
+        if (m_epoll_fd >= 0) {
+            close(m_epoll_fd);
+        }
+        if (m_wake_fd >= 0) {
+            close(m_wake_fd);
+        }
+        throw std::runtime_error("Failed to create idle connection poller");
+    }
+
+    epoll_event wake_event{};
+    wake_event.events = EPOLLIN;
+    wake_event.data.fd = m_wake_fd;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &wake_event);
+
+    m_thread = std::thread(&idle_poller::poll, this);
+}
+
+idle_poller::~idle_poller() {
+    shutdown();
+}
+
+bool idle_poller::park(int client_socket, size_t requests) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopping) {
+        return false;
+    }
+
+    parked& entry = m_parked[client_socket];
+    entry.requests = requests;
+    entry.serial = ++m_serial;
+    entry.waiting = true;
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.fd = client_socket;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, client_socket, &event) < 0) {
+        m_parked.erase(client_socket);
+        return false;
+    }
+
+    if (m_timeout.count() > 0) {
+        if (m_expiries.empty()) {
+            uint64_t value = 1;
+            ssize_t ignored = write(m_wake_fd, &value, sizeof(value));
+            (void)ignored;
+        }
+        m_expiries.push_back({std::chrono::steady_clock::now() + m_timeout, client_socket, entry.serial});
+    }
+    return true;
+}
+
+size_t idle_poller::take(int client_socket) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_parked.find(client_socket);
+    if (found == m_parked.end()) {
+        return 0;
+    }
+    size_t requests = found->second.requests;
+    m_parked.erase(found);
+    return requests;
+}
+
+int idle_poller::nextTimeout() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_expiries.empty()) {
+        return -1;
+    }
+    auto wait = std::chrono::ceil<std::chrono::milliseconds>(m_expiries.front().deadline -
+                                                             std::chrono::steady_clock::now());
+    return wait.count() > 0 ? static_cast<int>(wait.count()) : 0;
+}
+
+void idle_poller::poll() {
+    epoll_event events[64];
+    std::vector<int> resumed;
+
+    while (!m_stopping) {
+        int ready = epoll_wait(m_epoll_fd, events, 64, nextTimeout());
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+
+        resumed.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (int i = 0; i < ready; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == m_wake_fd) {
+                    uint64_t value;
+                    ssize_t ignored = read(m_wake_fd, &value, sizeof(value));
+                    (void)ignored;
+                    continue;
+                }
+
+                auto found = m_parked.find(fd);
+                if (found == m_parked.end() || !found->second.waiting) {
+                    continue;
+                }
+                found->second.waiting = false;
+                epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+                resumed.push_back(fd);
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            while (!m_expiries.empty() && m_expiries.front().deadline <= now) {
+                expiry expired = m_expiries.front();
+                m_expiries.pop_front();
+                auto found = m_parked.find(expired.fd);
+                if (found == m_parked.end() || !found->second.waiting || found->second.serial != expired.serial) {
+                    continue;
+                }
+                epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, expired.fd, nullptr);
+                close(expired.fd);
+                m_parked.erase(found);
+            }
+        }
+
+        for (int fd : resumed) {
+            m_resume(fd);
+        }
+    }
+}
+
+void idle_poller::shutdown() {
+    if (m_stopping.exchange(true)) {
+        return;
+    }
+
+    uint64_t value = 1;
+    ssize_t ignored = write(m_wake_fd, &value, sizeof(value));
+    (void)ignored;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_parked.begin(); it != m_parked.end();) {
+        if (it->second.waiting) {
+            close(it->first);
+            it = m_parked.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_expiries.clear();
+    close(m_epoll_fd);
+    close(m_wake_fd);
+}
+
+}
@@ -0,0 +1,214 @@
+#include "../include/range.hpp"
+#include "../include/conditional.hpp"
+#include "../include/file_cache.hpp"
+#include "../include/header_tokens.hpp"
+#include <charconv>
+#include <cstdio>
+#include <random>
+#include <strings.h>
+#include <unistd.h>
+
+namespace ghettp {
+
+static const size_t max_ranges = 16;
+static const size_t max_multipart_bytes = 8 * 1024 * 1024;
+
+static bool parseNumber(std::string_view text, size_t& value) {
+    if (text.empty()) {
+        return false;
+    }
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+static std::string contentRange(size_t first, size_t length, size_t total) {
+    char buffer[80];
+    snprintf(buffer, sizeof(buffer), "bytes %zu-%zu/%zu", first, first + length - 1, total);
+    return buffer;
+}
+
+static bool readRange(const HttpResponse& response, size_t first, size_t length, std::string& out) {
+    if (first < response.body.size()) {
+        size_t count = std::min(length, response.body.size() - first);
+        out.append(response.body, first, count);
+        first += count;
+        length -= count;
+    }
+
+    size_t position = response.file_offset + (first - response.body.size());
+    size_t start = out.size();
+    out.resize(start + length);
+    while (length > 0) {
+        ssize_t bytes_read = pread(response.file->fd, &out[start], length, static_cast<off_t>(position));
+        if (bytes_read <= 0) {
+            return false;
+        }
+        start += bytes_read;
+        position += bytes_read;
+        length -= bytes_read;
+    }
+    return true;
+}
+
+bool parseRanges(std::string_view header, size_t length, ByteRanges& ranges, bool& satisfiable) {
+    ranges.clear();
+    satisfiable = false;
+
+    header = trim(header);
+    if (header.size() < 6 || strncasecmp(header.data(), "bytes=", 6) != 0) {
+        return false;
+    }
+    header.remove_prefix(6);
+
+    size_t count = 0;
+    std::string_view spec;
+    while (nextListItem(header, spec)) {
+        if (spec.empty()) {
+            continue;
+        }
+        if (++count > max_ranges) {
+            return false;
+        }
+
+        size_t dash = spec.find('-');
+        if (dash == std::string_view::npos) {
+            return false;
+        }
+
+        size_t first;
+        size_t last;
+        if (dash == 0) {
+            size_t suffix;
+            if (!parseNumber(spec.substr(1), suffix)) {
+                return false;
+            }
+            if (suffix == 0 || length == 0) {
+                continue;
+            }
+            first = suffix < length ? length - suffix : 0;
+            last = length - 1;
+        } else {
+            if (!parseNumber(spec.substr(0, dash), first)) {
+                return false;
+            }
+            std::string_view end = spec.substr(dash + 1);
+            if (end.empty()) {
+                last = length - 1;
+            } else if (!parseNumber(end, last) || last < first) {
+                return false;
+            }
+            if (first >= length) {
+                continue;
+            }
+            last = std::min(last, length - 1);
+        }
+        ranges.emplace_back(first, last - first + 1);
+    }
+
+    satisfiable = !ranges.empty();
+    return count > 0;
+}
+
+bool rangeApplies(const HttpRequestView& request, const HttpResponse& response) {
+    std::string_view if_range = trim(request.header("If-Range"));
+    if (if_range.empty()) {
+        return true;
+    }
+
+    if (if_range.front() == '"' || if_range.substr(0, 2) == "W/") {
+        auto etag = response.headers.find("ETag");
+        return etag != response.headers.end() && etag->second.compare(0, 2, "W/") != 0 && etag->second == if_range;
+    }
+
+    auto last_modified = response.headers.find("Last-Modified");
+    time_t since;
+    time_t modified;
+    return last_modified != response.headers.end() && parseHttpDate(if_range, since) &&
+           parseHttpDate(last_modified->second, modified) && since == modified;
+}
+
+void applyRange(const HttpRequestView& request, HttpResponse& response) {
+    if (response.status_code != 200) {
+        return;
+    }
+    response.headers["Accept-Ranges"] = "bytes";
+
+    std::string_view header = request.header("Range");
+    if (header.empty() || request.method_id != http_method::get || !rangeApplies(request, response)) {
+        return;
+    }
+
+    size_t length = response.body.size() + (response.file ? response.file_length : 0);
+    ByteRanges ranges;
+    bool satisfiable;
+    if (!parseRanges(header, length, ranges, satisfiable)) {
+        return;
+    }
+
+    if (!satisfiable) {
+        response.status_code = 416;
+        response.headers["Content-Range"] = "bytes */" + std::to_string(length);
+        response.body.clear();
+        response.file.reset();
+        response.file_length = 0;
+        return;
+    }
+
+    if (ranges.size() == 1) {
+        size_t first = ranges[0].first;
+        size_t count = ranges[0].second;
+        std::string body;
+        if (response.file && response.body.empty()) {
+            response.file_offset += first;
+            response.file_length = count;
+        } else if (readRange(response, first, count, body)) {
+            response.body = std::move(body);
+            response.file.reset();
+            response.file_length = 0;
+        } else {
+            return;
+        }
+        response.status_code = 206;
+        response.headers["Content-Range"] = contentRange(first, count, length);
+        return;
+    }
+
+    size_t total = 0;
+    for (const auto& range : ranges) {
+        total += range.second;
+    }
+    if (total > max_multipart_bytes) {
+        return;
+    }
+
+    thread_local std::mt19937_64 generator(std::random_device{}());
+    char boundary[24];
+    snprintf(boundary, sizeof(boundary), "%016llx", static_cast<unsigned long long>(generator()));
+
+    auto content_type = response.headers.find("Content-Type");
+    std::string part_type = content_type != response.headers.end() ? content_type->second : "application/octet-stream";
+
+    std::string body;
+    body.reserve(total + ranges.size() * 128);
+    for (const auto& range : ranges) {
+        body += "--";
+        body += boundary;
+        body += "\r\nContent-Type: " + part_type;
+        body += "\r\nContent-Range: " + contentRange(range.first, range.second, length) + "\r\n\r\n";
+        if (!readRange(response, range.first, range.second, body)) {
+            return;
+        }
+        body += "\r\n";
+    }
+    body += "--";
+    body += boundary;
+    body += "--\r\n";
+
+    response.status_code = 206;
+    response.headers["Content-Type"] = std::string("multipart/byteranges; boundary=") + boundary;
+    response.body = std::move(body);
+    response.file.reset();
+    response.file_length = 0;
+}
+
+}
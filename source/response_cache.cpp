@@ -0,0 +1,194 @@
+#include "../include/response_cache.hpp"
+#include "../include/compression.hpp"
+#include "../include/header_tokens.hpp"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace ghettp {
+
+bool cacheableRequest(const HttpRequestView& request) {
+    return request.method_id == http_method::get && request.header("Authorization").empty() &&
+           request.header("Cookie").empty();
+}
+
+bool cacheableResponse(const HttpResponse& response) {
+    switch (response.status_code) {
+        case 200: case 203: case 204: case 301: case 404: case 410:
+            break;
+        default:
+            return false;
+    }
+    if (response.stream || response.file || response.headers.count("Set-Cookie") ||
+        response.headers.count("Connection")) {
+        return false;
+    }
+    auto cache_control = response.headers.find("Cache-Control");
+    if (cache_control != response.headers.end() &&
+        (containsToken(cache_control->second, "no-store") || containsToken(cache_control->second, "private"))) {
+        return false;
+    }
+    auto vary = response.headers.find("Vary");
+    return vary == response.headers.end() || !containsToken(vary->second, "*");
+}
+
+std::string requestKey(const HttpRequestView& request) {
+    std::string key;
+    key.reserve(request.method.size() + request.path.size() + request.query.size() + 2);
+    key.append(request.method);
+    key.push_back(' ');
+    key.append(request.path);
+    if (!request.query.empty()) {
+        key.push_back('?');
+        key.append(request.query);
+    }
+    return key;
+}
+
+response_cache::response_cache(size_t max_bytes) {
+    size_t wanted = std::max<size_t>(std::thread::hardware_concurrency(), 1) * 2;
+    m_shard_count = 1;
+    while (m_shard_count < wanted && m_shard_count < 64) {
+        m_shard_count <<= 1;
+    }
+    m_shards.reset(new shard[m_shard_count]);
+    m_shard_budget = max_bytes / m_shard_count;
+}
+
+void response_cache::appendVary(const HttpRequestView& request, std::string_view names, std::string& key) {
+    std::string_view name;
+    while (nextListItem(names, name)) {
+        if (name.empty()) {
+            continue;
+        }
+
+        key.push_back('\n');
+        std::string_view value = request.header(name);
+        if (equalsIgnoreCase(name, "Accept-Encoding")) {
+            value = codingName(negotiateEncoding(value));
+        }
+        key.append(value);
+    }
+}
+
+response_cache::shard& response_cache::shardFor(const std::string& primary) const {
+    return m_shards[std::hash<std::string>()(primary) & (m_shard_count - 1)];
+}
+
+void response_cache::evict(shard& target, size_t slot) {
+    entry& victim = target.entries[slot];
+    target.bytes -= victim.bytes;
+    if (--victim.vary->second.entries == 0) {
+        target.vary.erase(victim.vary->first);
+    }
+    target.index.erase(*victim.key);
+    victim = entry();
+    target.free.push_back(slot);
+}
+
+std::shared_ptr<const SerializedResponse> response_cache::find(const HttpRequestView& request) {
+    std::string key = requestKey(request);
+    shard& target = shardFor(key);
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(target.mutex);
+    auto vary = target.vary.find(key);
+    if (vary == target.vary.end()) {
+        ++target.counters.misses;
+        return nullptr;
+    }
+    appendVary(request, vary->second.names, key);
+
+    auto found = target.index.find(key);
+    if (found == target.index.end()) {
+        ++target.counters.misses;
+        return nullptr;
+    }
+    entry& cached = target.entries[found->second];
+    if (cached.expires <= now) {
+        evict(target, found->second);
+        ++target.counters.misses;
+        return nullptr;
+    }
+    cached.referenced = true;
+    ++target.counters.hits;
+    return cached.response;
+}
+
+void response_cache::store(const HttpRequestView& request, const HttpResponse& response,
+                           std::shared_ptr<const SerializedResponse> serialized, std::chrono::milliseconds ttl) {
+    std::string primary = requestKey(request);
+    auto vary_header = response.headers.find("Vary");
+    std::string names = vary_header != response.headers.end() ? vary_header->second : std::string();
+    std::string key = primary;
+    appendVary(request, names, key);
+
+    size_t bytes = key.size() + serialized->wire.size();
+    if (bytes > m_shard_budget) {
+        return;
+    }
+
+    shard& target = shardFor(primary);
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(target.mutex);
+
+    auto existing = target.index.find(key);
+    if (existing != target.index.end()) {
+        evict(target, existing->second);
+    }
+    while (target.bytes + bytes > m_shard_budget && !target.index.empty()) {
+        if (target.hand >= target.entries.size()) {
+            target.hand = 0;
+        }
+        entry& candidate = target.entries[target.hand];
+        if (candidate.response) {
+            if (candidate.referenced && candidate.expires > now) {
+                candidate.referenced = false;
+            } else {
+                evict(target, target.hand);
+                ++target.counters.evictions;
+            }
+        }
+        ++target.hand;
+    }
+
+    size_t slot;
+    if (target.free.empty()) {
+        slot = target.entries.size();
+        target.entries.emplace_back();
+    } else {
+        slot = target.free.back();
+        target.free.pop_back();
+    }
+
+    auto record = target.vary.try_emplace(primary).first;
+    record->second.names = std::move(names);
+    ++record->second.entries;
+
+    entry& cached = target.entries[slot];
+    cached.key = &target.index.emplace(std::move(key), slot).first->first;
+    cached.vary = &*record;
+    cached.response = std::move(serialized);
+    cached.expires = now + ttl;
+    cached.bytes = bytes;
+    cached.referenced = false;
+    target.bytes += bytes;
+    ++target.counters.stores;
+}
+
+cache_counters response_cache::counters() const {
+    cache_counters total;
+    for (size_t i = 0; i < m_shard_count; ++i) {
+        shard& target = m_shards[i];
+        std::lock_guard<std::mutex> lock(target.mutex);
+        total.hits += target.counters.hits;
+        total.misses += target.counters.misses;
+        total.stores += target.counters.stores;
+        total.evictions += target.counters.evictions;
+        total.entries += target.index.size();
+        total.bytes += target.bytes;
+    }
+    return total;
+}
+
+}
@@ -0,0 +1,140 @@
+#include "../include/router.hpp"
+#include <stdexcept>
+
+namespace ghettp {
+
+static size_t staticLength(std::string_view pattern) {
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        if ((pattern[i] == ':' || pattern[i] == '*') && (i == 0 || pattern[i - 1] == '/')) {
+            return i;
+        }
+    }
+    return pattern.size();
+}
+
+void router::add(std::string_view pattern, route target) {
+    if (pattern.empty() || pattern[0] != '/') {
+        throw std::runtime_error("Route must start with '/'");
+    }
+
+    node* current = &m_root;
+    while (!pattern.empty()) {
+        if (pattern[0] == ':') {
+            size_t end = pattern.find('/');
+            std::string_view name = pattern.substr(1, end == std::string_view::npos ? end : end - 1);
+            if (name.empty()) {
+                throw std::runtime_error("Route parameter must be named");
+            }
+            if (!current->param) {
+                current->param.reset(new node());
+                current->param->name.assign(name);
+            } else if (current->param->name != name) {
+                throw std::runtime_error("Conflicting route parameter names");
+            }
+            current = current->param.get();
+            pattern.remove_prefix(name.size() + 1);
+        } else if (pattern[0] == '*') {
+            std::string_view name = pattern.substr(1);
+            if (name.empty() || name.find('/') != std::string_view::npos) {
+                throw std::runtime_error("Route wildcard must be named and last");
+            }
+            if (!current->wildcard) {
+                current->wildcard.reset(new node());
+                current->wildcard->name.assign(name);
+            } else if (current->wildcard->name != name) {
+                throw std::runtime_error("Conflicting route wildcard names");
+            }
+            current = current->wildcard.get();
+            pattern = std::string_view();
+        } else {
+            size_t length = staticLength(pattern);
+            current = insertStatic(current, pattern.substr(0, length));
+            pattern.remove_prefix(length);
+        }
+    }
+
+    if (!current->target) {
+        ++m_size;
+    }
+    current->target.reset(new route(std::move(target)));
+}
+
+router::node* router::insertStatic(node* parent, std::string_view text) {
+    while (!text.empty()) {
+        size_t index = parent->indices.find(text[0]);
+        if (index == std::string::npos) {
+            std::unique_ptr<node> child(new node());
+            child->prefix.assign(text);
+            parent->indices.push_back(text[0]);
+            parent->children.push_back(std::move(child));
+            return parent->children.back().get();
+        }
+
+        node* child = parent->children[index].get();
+        size_t common = 0;
+        while (common < text.size() && common < child->prefix.size() && text[common] == child->prefix[common]) {
+            ++common;
+        }
+
+        if (common < child->prefix.size()) {
+            std::unique_ptr<node> split(new node());
+            split->prefix = child->prefix.substr(0, common);
+            child->prefix.erase(0, common);
+            split->indices.push_back(child->prefix[0]);
+            split->children.push_back(std::move(parent->children[index]));
+            parent->children[index] = std::move(split);
+            child = parent->children[index].get();
+        }
+
+        parent = child;
+        text.remove_prefix(common);
+    }
+    return parent;
+}
+
+const route* router::find(std::string_view path, RouteParams& params) const {
+    params.clear();
+    return match(&m_root, path, params);
+}
+
+const route* router::match(const node* current, std::string_view path, RouteParams& params) {
+    if (path.empty() && current->target) {
+        return current->target.get();
+    }
+
+    if (!path.empty()) {
+        size_t index = current->indices.find(path[0]);
+        if (index != std::string::npos) {
+            const node* child = current->children[index].get();
+            if (path.compare(0, child->prefix.size(), child->prefix) == 0) {
+                const route* found = match(child, path.substr(child->prefix.size()), params);
+                if (found) {
+                    return found;
+                }
+            }
+        }
+
+        if (current->param) {
+            size_t end = path.find('/');
+            if (end != 0) {
+                params.emplace_back(current->param->name, path.substr(0, end));
+                const route* found = match(current->param.get(),
+                                           end == std::string_view::npos ? std::string_view() : path.substr(end),
+                                           params);
+                if (found) {
+                    return found;
+                }
+                params.pop_back();
+            }
+        }
+    }
+
+    if (current->wildcard && current->wildcard->target) {
+        params.emplace_back(current->wildcard->name, path);
+        return current->wildcard->target.get();
+    }
+
+    return nullptr;
+}
+
+}
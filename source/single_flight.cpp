@@ -0,0 +1,85 @@
+#include "../include/single_flight.hpp"
+#include "../include/header_tokens.hpp"
+#include "../include/response_cache.hpp"
+
+namespace ghettp {
+
+void single_flight::finish(const std::string& key, call& flight, const HttpRequestView& request,
+                           const HttpResponse* response, std::exception_ptr error) {
+    size_t waiters;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_calls.erase(key);
+        waiters = flight.waiters;
+    }
+    {
+        std::lock_guard<std::mutex> lock(flight.mutex);
+        if (waiters > 0 && response && !response->stream) {
+            flight.shared = true;
+            auto vary = response->headers.find("Vary");
+            std::string_view names = vary != response->headers.end() ? std::string_view(vary->second) : std::string_view();
+            std::string_view name;
+            while (flight.shared && nextListItem(names, name)) {
+                if (name == "*") {
+                    flight.shared = false;
+                } else if (!name.empty()) {
+                    flight.vary.emplace_back(name, request.header(name));
+                }
+            }
+            if (flight.shared) {
+                flight.response = *response;
+            }
+        }
+        flight.error = error;
+        flight.finished = true;
+    }
+    flight.done.notify_all();
+}
+
+bool single_flight::matches(const call& flight, const HttpRequestView& request) {
+    for (const auto& header : flight.vary) {
+        if (request.header(header.first) != header.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+HttpResponse single_flight::run(const HttpRequestView& request, const std::function<HttpResponse()>& work) {
+    std::string key = requestKey(request);
+    std::shared_ptr<call> flight;
+    bool leader;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_calls.try_emplace(key);
+        leader = found.second;
+        if (leader) {
+            found.first->second = std::make_shared<call>();
+        } else {
+            ++found.first->second->waiters;
+        }
+        flight = found.first->second;
+    }
+
+    if (leader) {
+        HttpResponse response;
+        try {
+            response = work();
+        } catch (...) {
+            finish(key, *flight, request, nullptr, std::current_exception());
+            throw;
+        }
+        finish(key, *flight, request, &response, nullptr);
+        return response;
+    }
+
+    std::unique_lock<std::mutex> lock(flight->mutex);
+    flight->done.wait(lock, [&flight]() { return flight->finished; });
+    lock.unlock();
+    if (flight->error) {
+        std::rethrow_exception(flight->error);
+    }
+    return flight->shared && matches(*flight, request) ? flight->response : work();
+}
+
+}
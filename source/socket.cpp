@@ -1,49 +1,297 @@
 #include "../include/socket.hpp"
+#include "../include/http_parser.hpp"
+#include "../include/http_status.hpp"
+#include "../include/file_cache.hpp"
+#include "../include/uring.hpp"
+#include "../include/worker_pool.hpp"
+#include "../include/idle_poller.hpp"
+#include "../include/header_tokens.hpp"
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <cerrno>
 #include <iostream>
-#include <sstream>
 #include <thread>
+#include <mutex>
 #include <cstring>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <ctime>
 
 namespace ghettp {
 
-socket::socket(int port) : m_port(port), m_socket_fd(-1) {
-    m_socket_fd = ::socket(AF_INET, SOCK_STREAM, 0);
-    if (m_socket_fd == -1) {
-        throw std::runtime_error("Failed to create socket");
+static_assert(statusLine(200) == "HTTP/1.1 200 OK\r\n");
+static_assert(reasonPhrase(404) == "Not Found");
+
+static const size_t stream_watermark = 64 * 1024;
+
+static std::string_view dateHeader() {
+    thread_local time_t cached_second = 0;
+    thread_local char cached_header[64];
+    thread_local size_t cached_length = 0;
+
+    time_t now = time(nullptr);
+    if (now != cached_second) {
+        tm utc;
+        gmtime_r(&now, &utc);
+        cached_length = strftime(cached_header, sizeof(cached_header), "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &utc);
+        cached_second = now;
     }
+    return std::string_view(cached_header, cached_length);
+}
 
-    int opt = 1;
-    if (setsockopt(m_socket_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        throw std::runtime_error("Failed to configure socket");
+struct output_queue {
+    struct segment {
+        size_t offset;
+        size_t length;
+        int body;
+        int file;
+        int serialized = -1;
+    };
+
+    std::string heads;
+    std::vector<std::string> bodies;
+    std::vector<std::shared_ptr<const static_file>> files;
+    std::vector<std::shared_ptr<const SerializedResponse>> serialized;
+    std::vector<segment> segments;
+    std::vector<iovec> iov;
+    size_t index = 0;
+    size_t offset = 0;
+
+    bool empty() const {
+        return index == segments.size();
+    }
+
+    void commitHead(size_t start) {
+        if (heads.size() == start) {
+            return;
+        }
+        if (!segments.empty() && segments.back().body < 0 && segments.back().file < 0 &&
+            segments.back().serialized < 0 && segments.back().offset + segments.back().length == start) {
+            segments.back().length += heads.size() - start;
+        } else {
+            segments.push_back({start, heads.size() - start, -1, -1});
+        }
+    }
+
+    void appendHead(std::string_view data) {
+        size_t start = heads.size();
+        heads.append(data);
+        commitHead(start);
+    }
+
+    void appendBody(std::string&& body) {
+        if (body.empty()) {
+            return;
+        }
+        bodies.push_back(std::move(body));
+        segments.push_back({0, bodies.back().size(), static_cast<int>(bodies.size() - 1), -1});
+    }
+
+    void appendFile(const std::shared_ptr<const static_file>& file, size_t position, size_t length) {
+        if (length == 0) {
+            return;
+        }
+        files.push_back(file);
+        segments.push_back({position, length, -1, static_cast<int>(files.size() - 1)});
+    }
+
+    void appendSerialized(const std::shared_ptr<const SerializedResponse>& response, size_t position, size_t length) {
+        if (length == 0) {
+            return;
+        }
+        serialized.push_back(response);
+        segments.push_back({position, length, -1, -1, static_cast<int>(serialized.size() - 1)});
+    }
+
+    const static_file* currentFile() const {
+        return !empty() && segments[index].file >= 0 ? files[segments[index].file].get() : nullptr;
+    }
+
+    off_t filePosition() const {
+        return static_cast<off_t>(segments[index].offset + offset);
+    }
+
+    size_t remaining() const {
+        return segments[index].length - offset;
+    }
+
+    bool last(size_t count) const {
+        return index + count == segments.size();
+    }
+
+    size_t gather() {
+        iov.clear();
+        for (size_t i = index; i < segments.size() && iov.size() < 64; ++i) {
+            const segment& part = segments[i];
+            if (part.file >= 0) {
+                break;
+            }
+            const char* base = part.serialized >= 0 ? serialized[part.serialized]->wire.data() + part.offset
+                             : part.body >= 0     ? bodies[part.body].data()
+                                                  : heads.data() + part.offset;
+            size_t skip = i == index ? offset : 0;
+            iov.push_back({const_cast<char*>(base + skip), part.length - skip});
+        }
+        return iov.size();
+    }
+
+    void consume(size_t bytes) {
+        while (bytes > 0 && index < segments.size()) {
+            size_t remaining = segments[index].length - offset;
+            if (bytes < remaining) {
+                offset += bytes;
+                return;
+            }
+            bytes -= remaining;
+            ++index;
+            offset = 0;
+        }
+        if (index == segments.size()) {
+            clear();
+        }
+    }
+
+    void clear() {
+        heads.clear();
+        bodies.clear();
+        files.clear();
+        serialized.clear();
+        segments.clear();
+        index = 0;
+        offset = 0;
+    }
+};
+
+static void appendChunk(output_queue& output, bool chunked, std::string&& chunk) {
+    if (chunk.empty()) {
+        return;
     }
+    if (chunked) {
+        char number[24];
+        char* end = std::to_chars(number, number + sizeof(number) - 2, chunk.size(), 16).ptr;
+        *end++ = '\r';
+        *end++ = '\n';
+        output.appendHead(std::string_view(number, end - number));
+        output.appendBody(std::move(chunk));
+        output.appendHead("\r\n");
+    } else {
+        output.appendBody(std::move(chunk));
+    }
+}
+
+struct socket::connection {
+    int fd;
+    http_parser parser;
+    HttpRequestView request;
+    std::string input;
+    size_t input_offset = 0;
+    output_queue output;
+    msghdr message{};
+    int pipe_fds[2] = {-1, -1};
+    size_t pipe_size = 0;
+    size_t piped = 0;
+    ResponseStream stream;
+    bool chunked = false;
+    BodyReader reader;
+    bool streaming_body = false;
+    size_t requests = 0;
+    bool keep_alive = true;
+    bool peer_closed = false;
+    bool readable = false;
+    std::chrono::steady_clock::time_point last_active;
+
+    connection(int client_socket, const server_options& options)
+        : fd(client_socket), parser(options.max_header_size, options.max_body_size) {
+    }
+
+    connection(const connection&) = delete;
+    connection& operator=(const connection&) = delete;
 
+    ~connection() {
+        if (pipe_fds[0] >= 0) {
+            close(pipe_fds[0]);
+            close(pipe_fds[1]);
+        }
+    }
+};
+
+socket::socket(int port, const server_options& options)
+    : m_port(port), m_options(options), m_socket_fd(-1) {
     memset(&m_address, 0, sizeof(m_address));
     m_address.sin_family = AF_INET;
     m_address.sin_addr.s_addr = INADDR_ANY;
     m_address.sin_port = htons(m_port);
 
-    if (bind(m_socket_fd, (struct sockaddr*)&m_address, sizeof(m_address)) < 0) {
-        throw std::runtime_error("Failed to bind socket");
-    }
+    m_socket_fd = openListener();
 
-    if (listen(m_socket_fd, 5) < 0) {
-        throw std::runtime_error("Failed to listen on socket");
+    if (!m_options.server_name.empty()) {
+        m_server_headers = "Server: " + m_options.server_name + "\r\n";
     }
 
-    m_request_handler = [](const HttpRequest& req) -> HttpResponse {
+    m_request_handler = [](const HttpRequestView& req) -> HttpResponse {
         HttpResponse response;
         response.status_code = 404;
-        response.status_text = "Not Found";
         response.body = "<html><body><h1>404 - Not Found</h1></body></html>";
         response.headers["Content-Type"] = "text/html";
         return response;
     };
 }
 
+int socket::openListener() const {
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        throw std::runtime_error("Failed to create socket");
+    }
+
+    int opt = 1;
+    int defer_accept = m_options.tcp_defer_accept;
+    int fastopen = m_options.tcp_fastopen;
+    int receive_buffer = m_options.receive_buffer;
+    int send_buffer = m_options.send_buffer;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+        (m_options.reuse_port && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) ||
+        (receive_buffer > 0 && setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer)) < 0) ||
+        (send_buffer > 0 && setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &send_buffer, sizeof(send_buffer)) < 0) ||
+        (defer_accept > 0 && setsockopt(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &defer_accept, sizeof(defer_accept)) < 0) ||
+        (fastopen > 0 && setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN, &fastopen, sizeof(fastopen)) < 0)) {
+        close(fd);
+        throw std::runtime_error("Failed to configure socket");
+    }
+
+    if (bind(fd, (const struct sockaddr*)&m_address, sizeof(m_address)) < 0) {
+        close(fd);
+        throw std::runtime_error("Failed to bind socket");
+    }
+
+    if (listen(fd, m_options.listen_backlog) < 0) {
+        close(fd);
+        throw std::runtime_error("Failed to listen on socket");
+    }
+    return fd;
+}
+
+void socket::configureClient(int client_socket) const {
+    if (m_options.tcp_nodelay) {
+        int opt = 1;
+        setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+    }
+}
+
 socket::~socket() {
     stop();
     if (m_socket_fd != -1) {
@@ -52,25 +300,743 @@ socket::~socket() {
 }
 
 void socket::setRequestHandler(RequestHandler handler) {
+    m_request_handler = [handler](const HttpRequestView& request) {
+        return handler(request.toRequest());
+    };
+}
+
+void socket::setRequestHandler(RequestDispatcher handler) {
     m_request_handler = handler;
 }
 
-void socket::run() {
+void socket::setBodyHandler(BodyDispatcher handler) {
+    m_body_handler = handler;
+}
+
+void socket::run(io_model model) {
     m_running = true;
     std::cout << "Server running on port " << m_port << std::endl;
 
+    m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wake_fd < 0) {
+        throw std::runtime_error("Failed to create wake descriptor");
+    }
+
+    bool served = false;
+    if (model == io_model::sharded) {
+        runSharded();
+        served = true;
+    } else if (m_options.backend == io_backend::io_uring) {
+        served = runUring(m_socket_fd);
+        if (!served) {
+            std::cerr << "io_uring unavailable, falling back to posix sockets" << std::endl;
+        }
+    }
+
+    if (!served && model == io_model::epoll) {
+        runEpoll();
+    } else if (!served) {
+        runThreaded();
+    }
+
+    close(m_wake_fd);
+    m_wake_fd = -1;
+}
+
+void socket::runThreaded() {
+    size_t threads = m_options.worker_threads;
+    if (threads == 0) {
+        threads = 4 * std::max(1u, std::thread::hardware_concurrency());
+    }
+    worker_pool* workers = nullptr;
+    idle_poller idle(m_options.idle_timeout, [this, &workers, &idle](int client_socket) {
+        if (!workers->submit(client_socket)) {
+            idle.take(client_socket);
+            rejectClient(client_socket);
+        }
+    });
+    worker_pool pool(threads, m_options.queue_depth, [this, &idle](int client_socket) {
+        handleClient(client_socket, idle);
+    });
+    workers = &pool;
+
     while (m_running) {
-        socklen_t addr_len = sizeof(m_address);
-        int client_socket = accept(m_socket_fd, (struct sockaddr*)&m_address, &addr_len);
+        int client_socket = accept4(m_socket_fd, nullptr, nullptr, SOCK_CLOEXEC);
         if (client_socket < 0) {
-            if (m_running) {
+            if (m_running && errno != EINTR) {
                 std::cerr << "Failed to accept connection" << std::endl;
             }
             continue;
         }
+        configureClient(client_socket);
 
-        std::thread client_thread(&socket::handleClient, this, client_socket);
-        client_thread.detach();
+        if (!pool.submit(client_socket)) {
+            rejectClient(client_socket);
+        }
+    }
+
+    pool.shutdown();
+    idle.shutdown();
+}
+
+static void setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        throw std::runtime_error("Failed to make socket non-blocking");
+    }
+}
+
+static void pinThread(int cpu) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+}
+
+void socket::runEpoll() {
+    setNonBlocking(m_socket_fd);
+
+    unsigned thread_count = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> loops;
+    for (unsigned i = 1; i < thread_count; ++i) {
+        loops.emplace_back(&socket::eventLoop, this, m_socket_fd);
+    }
+    eventLoop(m_socket_fd);
+
+    for (auto& loop : loops) {
+        loop.join();
+    }
+}
+
+void socket::runSharded() {
+    cpu_set_t available;
+    CPU_ZERO(&available);
+    std::vector<int> cpus;
+    if (sched_getaffinity(0, sizeof(available), &available) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &available)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    if (cpus.empty()) {
+        cpus.push_back(0);
+    }
+    size_t shard_count = m_options.shards > 0 ? m_options.shards : cpus.size();
+
+    std::vector<int> listeners = {m_socket_fd};
+    if (!m_options.reuse_port) {
+        std::cerr << "reuse_port is off, shards share one listener" << std::endl;
+        listeners.resize(shard_count, m_socket_fd);
+    }
+    try {
+        while (listeners.size() < shard_count) {
+            listeners.push_back(openListener());
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << ", running " << listeners.size() << " shards" << std::endl;
+        shard_count = listeners.size();
+    }
+
+    std::once_flag fallback_notice;
+    auto runShard = [this, &fallback_notice](int listen_fd, int cpu) {
+        pinThread(cpu);
+        if (m_options.backend == io_backend::io_uring) {
+            if (runUring(listen_fd)) {
+                return;
+            }
+            std::call_once(fallback_notice, []() {
+                std::cerr << "io_uring unavailable, falling back to posix sockets" << std::endl;
+            });
+        }
+        setNonBlocking(listen_fd);
+        eventLoop(listen_fd);
+    };
+
+    std::vector<std::thread> shards;
+    for (size_t i = 1; i < shard_count; ++i) {
+        shards.emplace_back(runShard, listeners[i], cpus[i % cpus.size()]);
+    }
+    runShard(listeners[0], cpus[0]);
+
+    for (auto& shard : shards) {
+        shard.join();
+    }
+    for (size_t i = 1; i < listeners.size(); ++i) {
+        if (listeners[i] != m_socket_fd) {
+            close(listeners[i]);
+        }
+    }
+}
+
+void socket::eventLoop(int listen_fd) {
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        std::cerr << "Failed to create epoll instance" << std::endl;
+        return;
+    }
+
+    epoll_event listen_event{};
+    listen_event.events = EPOLLIN | EPOLLEXCLUSIVE;
+    listen_event.data.fd = listen_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &listen_event);
+
+    epoll_event wake_event{};
+    wake_event.events = EPOLLIN;
+    wake_event.data.fd = m_wake_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &wake_event);
+
+    std::unordered_map<int, connection> connections;
+    auto closeConnection = [&](int fd) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        connections.erase(fd);
+    };
+
+    auto idle_timeout = m_options.idle_timeout;
+    int wait_timeout = idle_timeout.count() > 0 ? 1000 : -1;
+    auto last_sweep = std::chrono::steady_clock::now();
+
+    epoll_event events[64];
+    while (m_running) {
+        int count = epoll_wait(epoll_fd, events, 64, wait_timeout);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        for (int i = 0; i < count && m_running; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == m_wake_fd) {
+                continue;
+            }
+
+            if (fd == listen_fd) {
+                for (size_t accepted = 0; accepted < std::max<size_t>(m_options.accept_batch, 1); ++accepted) {
+                    int client_socket = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                    if (client_socket < 0) {
+                        break;
+                    }
+                    configureClient(client_socket);
+
+                    epoll_event client_event{};
+                    client_event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+                    client_event.data.fd = client_socket;
+                    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_socket, &client_event) < 0) {
+                        close(client_socket);
+                        continue;
+                    }
+                    connection& conn = connections.try_emplace(client_socket, client_socket, m_options).first->second;
+                    conn.last_active = now;
+                }
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) {
+                continue;
+            }
+            connection& conn = it->second;
+            conn.last_active = now;
+
+            if (events[i].events & EPOLLERR) {
+                closeConnection(fd);
+                continue;
+            }
+
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+                conn.readable = true;
+            }
+
+            if (!serviceConnection(conn)) {
+                closeConnection(fd);
+            }
+        }
+
+        if (wait_timeout > 0 && now - last_sweep >= std::chrono::seconds(1)) {
+            last_sweep = now;
+            std::vector<int> expired;
+            for (const auto& entry : connections) {
+                if (now - entry.second.last_active > idle_timeout) {
+                    expired.push_back(entry.first);
+                }
+            }
+            for (int fd : expired) {
+                closeConnection(fd);
+            }
+        }
+    }
+
+    for (auto& entry : connections) {
+        close(entry.first);
+    }
+    close(epoll_fd);
+}
+
+bool socket::serviceConnection(connection& conn) {
+    while (true) {
+        if (!conn.output.empty()) {
+            if (!flushConnection(conn)) {
+                return false;
+            }
+            if (!conn.output.empty()) {
+                return true;
+            }
+        }
+
+        if (conn.stream) {
+            if (!produceOutput(conn)) {
+                return false;
+            }
+            continue;
+        }
+        if (!conn.keep_alive) {
+            return false;
+        }
+        if (processRequests(conn) > 0 || !conn.output.empty()) {
+            continue;
+        }
+        if (!conn.readable || conn.peer_closed || !m_running) {
+            return !conn.peer_closed && m_running;
+        }
+        conn.peer_closed = !readConnection(conn);
+    }
+}
+
+bool socket::runUring(int listen_fd) {
+    enum operation : uint64_t {
+        op_accept, op_recv, op_send, op_close, op_wake, op_timeout, op_fill, op_spool, op_spool_write
+    };
+    auto tag = [](operation op, int fd) { return (static_cast<uint64_t>(op) << 32) | static_cast<uint32_t>(fd); };
+
+    uring ring;
+    if (!ring.init(256, 256, 4096)) {
+        return false;
+    }
+
+    std::unordered_map<int, connection> connections;
+
+    __kernel_timespec idle_timeout{};
+    idle_timeout.tv_sec = m_options.idle_timeout.count() / 1000;
+    idle_timeout.tv_nsec = (m_options.idle_timeout.count() % 1000) * 1000000;
+    bool use_timeout = m_options.idle_timeout.count() > 0;
+
+    auto armAccept = [&]() {
+        if (!ring.reserve(1)) {
+            return false;
+        }
+        io_uring_sqe* sqe = ring.next();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = listen_fd;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_CLOEXEC;
+        sqe->user_data = tag(op_accept, listen_fd);
+        return true;
+    };
+    auto armTimeout = [&](io_uring_sqe* sqe, int fd) {
+        if (use_timeout) {
+            sqe->flags |= IOSQE_IO_LINK;
+            io_uring_sqe* timeout = ring.next();
+            timeout->opcode = IORING_OP_LINK_TIMEOUT;
+            timeout->addr = reinterpret_cast<uint64_t>(&idle_timeout);
+            timeout->len = 1;
+            timeout->user_data = tag(op_timeout, fd);
+        }
+    };
+    auto armRecv = [&](int fd) {
+        if (!ring.reserve(2)) {
+            return false;
+        }
+        io_uring_sqe* sqe = ring.next();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = fd;
+        sqe->len = ring.bufferSize();
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = 0;
+        sqe->user_data = tag(op_recv, fd);
+        armTimeout(sqe, fd);
+        return true;
+    };
+    auto armClose = [&](int fd) {
+        if (!ring.reserve(1)) {
+            return false;
+        }
+        io_uring_sqe* sqe = ring.next();
+        sqe->opcode = IORING_OP_CLOSE;
+        sqe->fd = fd;
+        sqe->user_data = tag(op_close, fd);
+        return true;
+    };
+    auto armSpool = [&](connection& conn) {
+        if (!openPipe(conn)) {
+            return armClose(conn.fd);
+        }
+        if (!ring.reserve(2)) {
+            return false;
+        }
+        io_uring_sqe* sqe = ring.next();
+        sqe->opcode = IORING_OP_SPLICE;
+        sqe->fd = conn.pipe_fds[1];
+        sqe->off = static_cast<uint64_t>(-1);
+        sqe->splice_fd_in = conn.fd;
+        sqe->splice_off_in = static_cast<uint64_t>(-1);
+        sqe->len = static_cast<unsigned>(std::min(conn.parser.bodyRemaining(), conn.pipe_size));
+        sqe->splice_flags = SPLICE_F_MOVE;
+        sqe->user_data = tag(op_spool, conn.fd);
+        armTimeout(sqe, conn.fd);
+        return true;
+    };
+    auto armSpoolWrite = [&](connection& conn) {
+        if (!ring.reserve(1)) {
+            return false;
+        }
+        io_uring_sqe* sqe = ring.next();
+        sqe->opcode = IORING_OP_SPLICE;
+        sqe->fd = conn.reader.spool_fd;
+        sqe->off = static_cast<uint64_t>(-1);
+        sqe->splice_fd_in = conn.pipe_fds[0];
+        sqe->splice_off_in = static_cast<uint64_t>(-1);
+        sqe->len = static_cast<unsigned>(conn.piped);
+        sqe->splice_flags = SPLICE_F_MOVE;
+        sqe->user_data = tag(op_spool_write, conn.fd);
+        return true;
+    };
+    auto armSend = [&](connection& conn) {
+        io_uring_sqe* sqe;
+        bool last;
+        if (const static_file* file = conn.output.currentFile()) {
+            if (!openPipe(conn)) {
+                return armClose(conn.fd);
+            }
+            if (!ring.reserve(3)) {
+                return false;
+            }
+
+            size_t length = conn.piped;
+            if (length == 0) {
+                size_t page_offset = static_cast<size_t>(conn.output.filePosition()) % 4096;
+                length = std::min(conn.output.remaining(), conn.pipe_size - page_offset);
+                io_uring_sqe* fill = ring.next();
+                fill->opcode = IORING_OP_SPLICE;
+                fill->splice_fd_in = file->fd;
+                fill->splice_off_in = static_cast<uint64_t>(conn.output.filePosition());
+                fill->fd = conn.pipe_fds[1];
+                fill->off = static_cast<uint64_t>(-1);
+                fill->len = static_cast<uint32_t>(length);
+                fill->flags = IOSQE_IO_LINK;
+                fill->user_data = tag(op_fill, conn.fd);
+            }
+
+            sqe = ring.next();
+            sqe->opcode = IORING_OP_SPLICE;
+            sqe->splice_fd_in = conn.pipe_fds[0];
+            sqe->splice_off_in = static_cast<uint64_t>(-1);
+            sqe->fd = conn.fd;
+            sqe->off = static_cast<uint64_t>(-1);
+            sqe->len = static_cast<uint32_t>(length);
+            last = conn.output.last(1) && length == conn.output.remaining();
+        } else {
+            if (!ring.reserve(2)) {
+                return false;
+            }
+            conn.message.msg_iovlen = conn.output.gather();
+            conn.message.msg_iov = conn.output.iov.data();
+
+            sqe = ring.next();
+            sqe->opcode = IORING_OP_SENDMSG;
+            sqe->fd = conn.fd;
+            sqe->addr = reinterpret_cast<uint64_t>(&conn.message);
+            sqe->len = 1;
+            last = conn.output.last(conn.message.msg_iovlen);
+            sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL | (last ? 0 : MSG_MORE);
+        }
+        sqe->user_data = tag(op_send, conn.fd);
+        if (!conn.keep_alive && !conn.stream && last) {
+            sqe->flags = IOSQE_IO_LINK;
+            armClose(conn.fd);
+        }
+        return true;
+    };
+
+    enum class step { accept, recv, close, spool, spool_write, send };
+    std::deque<std::pair<step, int>> stalled;
+    auto tryArm = [&](step action, int fd) {
+        if (action == step::accept) {
+            return armAccept();
+        }
+        if (action == step::close) {
+            return armClose(fd);
+        }
+        if (action == step::recv) {
+            return armRecv(fd);
+        }
+        auto it = connections.find(fd);
+        if (it == connections.end()) {
+            return true;
+        }
+        if (action == step::spool) {
+            return armSpool(it->second);
+        }
+        if (action == step::spool_write) {
+            return armSpoolWrite(it->second);
+        }
+        return armSend(it->second);
+    };
+    auto arm = [&](step action, int fd) {
+        if (!stalled.empty() || !tryArm(action, fd)) {
+            stalled.emplace_back(action, fd);
+        }
+    };
+    auto advanceConnection = [&](connection& conn) {
+        if (conn.stream && !produceOutput(conn)) {
+            arm(step::close, conn.fd);
+        } else if (processRequests(conn) > 0 || !conn.output.empty()) {
+            arm(step::send, conn.fd);
+        } else if (!conn.keep_alive || conn.peer_closed || !m_running) {
+            arm(step::close, conn.fd);
+        } else if (spooling(conn)) {
+            arm(step::spool, conn.fd);
+        } else {
+            arm(step::recv, conn.fd);
+        }
+    };
+
+    if (!ring.reserve(2)) {
+        return false;
+    }
+    io_uring_sqe* wake = ring.next();
+    wake->opcode = IORING_OP_POLL_ADD;
+    wake->fd = m_wake_fd;
+    wake->poll32_events = POLLIN;
+    wake->user_data = tag(op_wake, m_wake_fd);
+    armAccept();
+
+    bool failed = false;
+    while (m_running) {
+        while (!stalled.empty() && tryArm(stalled.front().first, stalled.front().second)) {
+            stalled.pop_front();
+        }
+        if (ring.submit(1) < 0 && errno != EINTR && errno != EBUSY && errno != EAGAIN) {
+            std::cerr << "io_uring_enter failed: " << strerror(errno) << std::endl;
+            failed = true;
+            break;
+        }
+
+        while (io_uring_cqe* cqe = ring.peek()) {
+            operation op = static_cast<operation>(cqe->user_data >> 32);
+            int fd = static_cast<int>(cqe->user_data & 0xffffffff);
+            int result = cqe->res;
+            unsigned flags = cqe->flags;
+            ring.advance();
+
+            if (op == op_accept) {
+                if (result >= 0) {
+                    configureClient(result);
+                    connections.try_emplace(result, result, m_options);
+                    arm(step::recv, result);
+                }
+                if (!(flags & IORING_CQE_F_MORE) && m_running) {
+                    arm(step::accept, listen_fd);
+                }
+            } else if (op == op_recv) {
+                auto it = connections.find(fd);
+                if (it == connections.end()) {
+                    continue;
+                }
+                connection& conn = it->second;
+
+                if (result > 0 && (flags & IORING_CQE_F_BUFFER)) {
+                    unsigned id = flags >> IORING_CQE_BUFFER_SHIFT;
+                    conn.input.append(ring.buffer(id), result);
+                    ring.recycle(id);
+                } else if (result != -ENOBUFS) {
+                    conn.peer_closed = true;
+                }
+                advanceConnection(conn);
+            } else if (op == op_send) {
+                auto it = connections.find(fd);
+                if (it == connections.end()) {
+                    continue;
+                }
+                connection& conn = it->second;
+
+                if (result <= 0) {
+                    arm(step::close, fd);
+                    continue;
+                }
+                if (conn.output.currentFile()) {
+                    conn.piped -= result;
+                }
+                conn.output.consume(result);
+                if (!conn.output.empty()) {
+                    arm(step::send, fd);
+                } else if (conn.keep_alive || conn.stream) {
+                    advanceConnection(conn);
+                }
+            } else if (op == op_spool || op == op_spool_write) {
+                auto it = connections.find(fd);
+                if (it == connections.end()) {
+                    continue;
+                }
+                connection& conn = it->second;
+
+                if (result <= 0) {
+                    arm(step::close, fd);
+                    continue;
+                }
+                if (op == op_spool) {
+                    conn.piped = result;
+                    arm(step::spool_write, fd);
+                    continue;
+                }
+                conn.piped -= result;
+                conn.parser.skipBody(result);
+                if (conn.piped > 0) {
+                    arm(step::spool_write, fd);
+                } else {
+                    advanceConnection(conn);
+                }
+            } else if (op == op_fill) {
+                auto it = connections.find(fd);
+                if (it != connections.end() && result > 0) {
+                    it->second.piped += result;
+                }
+            } else if (op == op_close) {
+                if (result != -ECANCELED) {
+                    connections.erase(fd);
+                }
+            } else if (op == op_wake) {
+                m_running = false;
+            }
+        }
+    }
+
+    for (auto& entry : connections) {
+        close(entry.first);
+    }
+    return !failed;
+}
+
+bool socket::readConnection(connection& conn) {
+    while (spooling(conn)) {
+        size_t remaining = conn.parser.bodyRemaining();
+        if (!spliceBody(conn)) {
+            return false;
+        }
+        if (conn.parser.bodyRemaining() == remaining) {
+            conn.readable = false;
+            return true;
+        }
+    }
+
+    size_t budget = m_options.max_header_size + conn.parser.bodyRemaining();
+    size_t received = 0;
+    char buffer[4096];
+    while (received < budget) {
+        ssize_t bytes_read = read(conn.fd, buffer, sizeof(buffer));
+        if (bytes_read > 0) {
+            conn.input.append(buffer, bytes_read);
+            received += bytes_read;
+            continue;
+        }
+        if (bytes_read < 0 && errno == EINTR) {
+            continue;
+        }
+        conn.readable = false;
+        return bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    return true;
+}
+
+bool socket::spooling(const connection& conn) {
+    return conn.streaming_body && conn.reader.spool_fd >= 0 && conn.parser.bodyRemaining() > 0;
+}
+
+bool socket::openPipe(connection& conn) {
+    if (conn.pipe_fds[0] >= 0) {
+        return true;
+    }
+    if (pipe2(conn.pipe_fds, O_CLOEXEC) < 0) {
+        return false;
+    }
+    fcntl(conn.pipe_fds[1], F_SETPIPE_SZ, 1 << 20);
+    conn.pipe_size = static_cast<size_t>(std::max(fcntl(conn.pipe_fds[1], F_GETPIPE_SZ), 4096));
+    return true;
+}
+
+bool socket::spliceBody(connection& conn) {
+    if (!openPipe(conn)) {
+        return false;
+    }
+
+    size_t length = std::min(conn.parser.bodyRemaining(), conn.pipe_size);
+    ssize_t received;
+    do {
+        received = splice(conn.fd, nullptr, conn.pipe_fds[1], nullptr, length, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    } while (received < 0 && errno == EINTR);
+    if (received < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    if (received == 0) {
+        return false;
+    }
+
+    size_t pending = received;
+    while (pending > 0) {
+        ssize_t written = splice(conn.pipe_fds[0], nullptr, conn.reader.spool_fd, nullptr, pending, SPLICE_F_MOVE);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        pending -= written;
+    }
+    conn.parser.skipBody(received);
+    return true;
+}
+
+bool socket::flushConnection(connection& conn) {
+    while (!conn.output.empty()) {
+        ssize_t bytes_sent;
+        if (const static_file* file = conn.output.currentFile()) {
+            off_t position = conn.output.filePosition();
+            bytes_sent = sendfile(conn.fd, file->fd, &position, conn.output.remaining());
+        } else {
+            conn.message.msg_iovlen = conn.output.gather();
+            conn.message.msg_iov = conn.output.iov.data();
+            int more = conn.output.last(conn.message.msg_iovlen) ? 0 : MSG_MORE;
+            bytes_sent = sendmsg(conn.fd, &conn.message, MSG_NOSIGNAL | more);
+        }
+        if (bytes_sent > 0) {
+            conn.output.consume(bytes_sent);
+            continue;
+        }
+        if (bytes_sent < 0 && errno == EINTR) {
+            continue;
+        }
+        return bytes_sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    return true;
+}
+
+bool socket::waitReadable(int client_socket) {
+    pollfd fds[2] = {
+        {client_socket, POLLIN, 0},
+        {m_wake_fd, POLLIN, 0},
+    };
+    int timeout = m_options.idle_timeout.count() > 0 ? static_cast<int>(m_options.idle_timeout.count()) : -1;
+
+    while (true) {
+        int ready = poll(fds, 2, timeout);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        return ready > 0 && fds[0].revents != 0 && m_running;
     }
 }
 
@@ -79,89 +1045,371 @@ void socket::stop() {
     if (m_socket_fd != -1) {
         shutdown(m_socket_fd, SHUT_RDWR);
     }
+    if (m_wake_fd != -1) {
+        uint64_t value = 1;
+        ssize_t ignored = write(m_wake_fd, &value, sizeof(value));
+        (void)ignored;
+    }
 }
 
-void socket::handleClient(int client_socket) {
-    char buffer[4096] = {0};
-    ssize_t bytes_read = read(client_socket, buffer, sizeof(buffer) - 1);
+void socket::handleClient(int client_socket, idle_poller& idle) {
+    connection conn(client_socket, m_options);
+    conn.requests = idle.take(client_socket);
+    char buffer[4096];
 
-    if (bytes_read <= 0) {
-        close(client_socket);
-        return;
-    }
+    while (true) {
+        if (processRequests(conn) > 0 || !conn.output.empty()) {
+            bool open = flushConnection(conn);
+            while (open && conn.stream) {
+                open = produceOutput(conn) && flushConnection(conn);
+            }
+            if (!open || !conn.keep_alive) {
+                break;
+            }
+            continue;
+        }
 
-    try {
-        std::string raw_request(buffer);
-        HttpRequest request = parseRequest(raw_request);
-        HttpResponse response = m_request_handler(request);
-        std::string response_str = buildResponse(response);
-        send(client_socket, response_str.c_str(), response_str.length(), 0);
-    } catch (const std::exception& e) {
-        std::string error_response =
-            "HTTP/1.1 500 Internal Server Error\r\n"
-            "Content-Type: text/plain\r\n"
-            "Content-Length: 21\r\n"
-            "\r\n"
-            "Internal Server Error";
-        send(client_socket, error_response.c_str(), error_response.length(), 0);
+        if (conn.input.empty() && !conn.streaming_body) {
+            ssize_t bytes_read = recv(client_socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (bytes_read > 0) {
+                conn.input.append(buffer, bytes_read);
+                continue;
+            }
+            if (bytes_read < 0 && errno == EINTR) {
+                continue;
+            }
+            if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && m_running &&
+                idle.park(client_socket, conn.requests)) {
+                return;
+            }
+            break;
+        }
+
+        if (!waitReadable(client_socket)) {
+            break;
+        }
+        if (spooling(conn)) {
+            if (!spliceBody(conn)) {
+                break;
+            }
+            continue;
+        }
+
+        ssize_t bytes_read = read(client_socket, buffer, sizeof(buffer));
+        if (bytes_read <= 0) {
+            break;
+        }
+        conn.input.append(buffer, bytes_read);
     }
 
     close(client_socket);
 }
 
-HttpRequest socket::parseRequest(const std::string& raw_request) {
-    HttpRequest request;
-    std::istringstream stream(raw_request);
-    std::string line;
+void socket::rejectClient(int client_socket) {
+    std::string busy_response = errorResponse(503);
+    send(client_socket, busy_response.data(), busy_response.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    close(client_socket);
+}
+
+size_t socket::processRequests(connection& conn) {
+    size_t processed = 0;
+    while (conn.keep_alive && !conn.stream && processRequest(conn)) {
+        ++processed;
+    }
 
-    if (std::getline(stream, line)) {
-        if (line.back() == '\r') {
-            line.pop_back();
+    if (conn.input_offset == conn.input.size()) {
+        conn.input.clear();
+    } else if (conn.input_offset > 0) {
+        conn.input.erase(0, conn.input_offset);
+    }
+    conn.input_offset = 0;
+    return processed;
+}
+
+bool socket::processRequest(connection& conn) {
+    char* data = &conn.input[conn.input_offset];
+    size_t size = conn.input.size() - conn.input_offset;
+    http_parser::result result = conn.parser.parse(data, size);
+    if (result == http_parser::result::head) {
+        conn.parser.view(data, conn.request);
+        try {
+            conn.streaming_body = m_body_handler && m_body_handler(conn.request, conn.reader);
+        } catch (const std::exception& e) {
+            conn.streaming_body = false;
+            conn.parser.reset();
+            conn.output.appendHead(errorResponse(500));
+            conn.keep_alive = false;
+            conn.input_offset = conn.input.size();
+            return true;
         }
-        std::istringstream first_line(line);
-        first_line >> request.method >> request.path >> request.version;
+        if (conn.streaming_body) {
+            conn.parser.streamBody();
+        }
+        result = conn.parser.parse(data, size);
+        if (result == http_parser::result::incomplete && expectsContinue(conn.request)) {
+            conn.output.appendHead("HTTP/1.1 100 Continue\r\n\r\n");
+        }
+    }
+
+    if (conn.streaming_body && result != http_parser::result::error && !feedBody(conn, data, size)) {
+        conn.streaming_body = false;
+        conn.reader = BodyReader();
+        conn.parser.reset();
+        conn.output.appendHead(errorResponse(500));
+        conn.keep_alive = false;
+        conn.input_offset = conn.input.size();
+        return true;
+    }
+    if (result == http_parser::result::incomplete) {
+        return false;
+    }
+
+    if (result == http_parser::result::error) {
+        conn.output.appendHead(errorResponse(conn.parser.errorStatus()));
+        conn.streaming_body = false;
+        conn.reader = BodyReader();
+        conn.keep_alive = false;
+        conn.input_offset = conn.input.size();
+        return true;
     }
 
-    while (std::getline(stream, line) && line != "\r") {
-        if (line.back() == '\r') {
-            line.pop_back();
+    ++conn.requests;
+    size_t limit = m_options.max_requests_per_connection;
+    bool allow_keep_alive = m_running && (limit == 0 || conn.requests < limit);
+
+    conn.parser.view(data, conn.request);
+    conn.keep_alive = respond(conn, allow_keep_alive);
+    conn.input_offset += conn.parser.consumed();
+    conn.parser.reset();
+    return true;
+}
+
+bool socket::feedBody(connection& conn, char* data, size_t size) {
+    http_parser::span decoded = conn.parser.decodedBody();
+    try {
+        if (decoded.length > 0) {
+            conn.reader.on_data(std::string_view(data + decoded.offset, decoded.length));
         }
-        size_t colon_pos = line.find(':');
-        if (colon_pos != std::string::npos) {
-            std::string key = line.substr(0, colon_pos);
-            std::string value = line.substr(colon_pos + 1);
-            if (!value.empty() && value[0] == ' ') {
-                value = value.substr(1);
+    } catch (const std::exception& e) {
+        return false;
+    }
+    conn.input.resize(conn.input_offset + conn.parser.releaseBody(data, size));
+    return true;
+}
+
+bool socket::respond(connection& conn, bool allow_keep_alive) {
+    output_queue& output = conn.output;
+    try {
+        bool keep_alive = allow_keep_alive && wantsKeepAlive(conn.request);
+
+        HttpResponse response;
+        if (conn.streaming_body) {
+            conn.streaming_body = false;
+            BodyReader reader = std::move(conn.reader);
+            conn.reader = BodyReader();
+            response = reader.on_complete(conn.request);
+        } else {
+            response = m_request_handler(conn.request);
+        }
+        if (response.serialized) {
+            const SerializedResponse& serialized = *response.serialized;
+            output.appendSerialized(response.serialized, 0, serialized.head_length);
+            size_t start = output.heads.size();
+            if (!serialized.dated) {
+                output.heads.append(dateHeader());
+            }
+            output.heads.append(keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+            output.commitHead(start);
+            if (conn.request.method_id != http_method::head) {
+                output.appendSerialized(response.serialized, serialized.head_length,
+                                        serialized.wire.size() - serialized.head_length);
             }
-            request.headers[key] = value;
+            return keep_alive;
         }
+
+        auto connection_header = response.headers.find("Connection");
+        if (connection_header != response.headers.end() && connection_header->second == "close") {
+            keep_alive = false;
+        }
+
+        conn.chunked = false;
+        if (response.stream) {
+            conn.chunked = conn.request.version != "HTTP/1.0";
+            keep_alive = keep_alive && conn.chunked;
+        }
+
+        size_t start = output.heads.size();
+        buildResponseHead(response, keep_alive, conn.chunked, output.heads);
+        output.commitHead(start);
+        if (conn.request.method_id == http_method::head) {
+            return keep_alive;
+        }
+        if (response.stream) {
+            conn.stream = std::move(response.stream);
+            appendChunk(output, conn.chunked, std::move(response.body));
+        } else {
+            output.appendBody(std::move(response.body));
+        }
+        if (response.file) {
+            output.appendFile(response.file, response.file_offset, response.file_length);
+        }
+        return keep_alive;
+    } catch (const std::exception& e) {
+        output.appendHead(errorResponse(500));
+        return false;
+    }
+}
+
+bool socket::produceOutput(connection& conn) {
+    try {
+        size_t produced = 0;
+        while (conn.stream && produced < stream_watermark) {
+            std::string chunk;
+            bool more = conn.stream(chunk);
+            produced += chunk.size();
+            appendChunk(conn.output, conn.chunked, std::move(chunk));
+            if (!more) {
+                conn.stream = nullptr;
+                if (conn.chunked) {
+                    conn.output.appendHead("0\r\n\r\n");
+                }
+            }
+        }
+        return true;
+    } catch (const std::exception& e) {
+        conn.stream = nullptr;
+        conn.keep_alive = false;
+        return false;
+    }
+}
+
+std::string socket::errorResponse(int status_code) const {
+    if (statusLine(status_code).empty()) {
+        status_code = 500;
+    }
+
+    std::string body(reasonPhrase(status_code));
+    return std::string(statusLine(status_code)) + std::string(dateHeader()) + m_server_headers +
+           "Content-Type: text/plain\r\n"
+           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+           "Connection: close\r\n"
+           "\r\n" + body;
+}
+
+bool socket::expectsContinue(const HttpRequestView& request) {
+    std::string_view expect = request.header("Expect");
+    return request.version == "HTTP/1.1" && equalsIgnoreCase(expect, "100-continue");
+}
+
+bool socket::wantsKeepAlive(const HttpRequestView& request) {
+    std::string_view connection_header = request.header("Connection");
+    if (containsToken(connection_header, "close")) {
+        return false;
+    }
+    if (containsToken(connection_header, "keep-alive")) {
+        return true;
     }
+    return request.version == "HTTP/1.1";
+}
 
-    std::string body_line;
-    while (std::getline(stream, body_line)) {
-        request.body += body_line + "\n";
+std::string_view HttpRequestView::header(std::string_view name) const {
+    for (const auto& entry : headers) {
+        if (equalsIgnoreCase(entry.first, name)) {
+            return entry.second;
+        }
     }
-    if (!request.body.empty()) {
-        request.body.pop_back();
+    return std::string_view();
+}
+
+std::string_view HttpRequestView::param(std::string_view name) const {
+    for (const auto& entry : params) {
+        if (entry.first == name) {
+            return entry.second;
+        }
     }
+    return std::string_view();
+}
 
+HttpRequest HttpRequestView::toRequest() const {
+    HttpRequest request;
+    request.method.assign(method);
+    request.path.assign(path);
+    request.query.assign(query);
+    request.version.assign(version);
+    for (const auto& entry : headers) {
+        request.headers[std::string(entry.first)] = std::string(entry.second);
+    }
+    for (const auto& entry : params) {
+        request.params[std::string(entry.first)] = std::string(entry.second);
+    }
+    request.body.assign(body);
+    request.body_fd = body_fd;
+    request.body_path.assign(body_path);
     return request;
 }
 
-std::string socket::buildResponse(const HttpResponse& response) {
-    std::ostringstream response_stream;
+bool socket::buildHeaders(const HttpResponse& response, bool chunked, std::string& out) const {
+    char number[24];
+    bool has_date = false;
+    bool has_server = false;
 
-    response_stream << "HTTP/1.1 " << response.status_code << " " << response.status_text << "\r\n";
+    std::string_view status_line = statusLine(response.status_code);
+    if (response.status_text.empty() && !status_line.empty()) {
+        out.append(status_line);
+    } else {
+        out.append("HTTP/1.1 ");
+        out.append(number, std::to_chars(number, number + sizeof(number), response.status_code).ptr);
+        out.push_back(' ');
+        out.append(response.status_text.empty() ? reasonPhrase(response.status_code) : response.status_text);
+        out.append("\r\n");
+    }
 
     for (const auto& header : response.headers) {
-        response_stream << header.first << ": " << header.second << "\r\n";
+        if (header.first == "Connection" || header.first == "Content-Length" ||
+            header.first == "Transfer-Encoding") {
+            continue;
+        }
+        has_date = has_date || header.first == "Date";
+        has_server = has_server || header.first == "Server";
+        out.append(header.first);
+        out.append(": ");
+        out.append(header.second);
+        out.append("\r\n");
     }
 
-    response_stream << "Content-Length: " << response.body.length() << "\r\n";
-    response_stream << "\r\n";
-    response_stream << response.body;
+    if (!has_server) {
+        out.append(m_server_headers);
+    }
+
+    if (response.stream) {
+        if (chunked) {
+            out.append("Transfer-Encoding: chunked\r\n");
+        }
+    } else if (response.status_code >= 200 && response.status_code != 204 && response.status_code != 304) {
+        out.append("Content-Length: ");
+        size_t content_length = response.body.size() + (response.file ? response.file_length : 0);
+        out.append(number, std::to_chars(number, number + sizeof(number), content_length).ptr);
+        out.append("\r\n");
+    }
+    return has_date;
+}
+
+void socket::buildResponseHead(const HttpResponse& response, bool keep_alive, bool chunked,
+                               std::string& out) const {
+    if (!buildHeaders(response, chunked, out)) {
+        out.append(dateHeader());
+    }
+    out.append(keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+    out.append("\r\n");
+}
 
-    return response_stream.str();
+std::shared_ptr<const SerializedResponse> socket::serialize(const HttpResponse& response) const {
+    auto serialized = std::make_shared<SerializedResponse>();
+    serialized->wire.reserve(256 + response.body.size());
+    serialized->dated = buildHeaders(response, false, serialized->wire);
+    serialized->head_length = serialized->wire.size();
+    serialized->wire.append(response.body);
+    return serialized;
 }
 
 }
@@ -0,0 +1,182 @@
+#include "../include/uring.hpp"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+
+namespace ghettp {
+
+static const unsigned buffer_group = 0;
+
+uring::~uring() {
+    release();
+}
+
+void uring::release() {
+    if (m_buf_ring) {
+        munmap(m_buf_ring, m_buf_ring_size);
+        m_buf_ring = nullptr;
+    }
+    if (m_buffers) {
+        munmap(m_buffers, static_cast<size_t>(m_buffer_count) * m_buffer_size);
+        m_buffers = nullptr;
+    }
+    if (m_sqes) {
+        munmap(m_sqes, m_sqes_size);
+        m_sqes = nullptr;
+    }
+    if (m_ring_ptr) {
+        munmap(m_ring_ptr, m_ring_size);
+        m_ring_ptr = nullptr;
+    }
+    if (m_ring_fd != -1) {
+        close(m_ring_fd);
+        m_ring_fd = -1;
+    }
+}
+
+bool uring::init(unsigned entries, unsigned buffer_count, unsigned buffer_size) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    m_ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (m_ring_fd < 0 || !(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        release();
+        return false;
+    }
+
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    m_ring_size = sq_size > cq_size ? sq_size : cq_size;
+    m_ring_ptr = mmap(nullptr, m_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      m_ring_fd, IORING_OFF_SQ_RING);
+    if (m_ring_ptr == MAP_FAILED) {
+        m_ring_ptr = nullptr;
+        release();
+        return false;
+    }
+
+    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      m_ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        release();
+        return false;
+    }
+    m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+    char* ring = static_cast<char*>(m_ring_ptr);
+    m_sq_head = reinterpret_cast<unsigned*>(ring + params.sq_off.head);
+    m_sq_tail = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+    m_sq_array = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+    m_sq_mask = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+    m_sq_entries = params.sq_entries;
+    m_sq_local_tail = *m_sq_tail;
+
+    m_cq_head = reinterpret_cast<unsigned*>(ring + params.cq_off.head);
+    m_cq_tail = reinterpret_cast<unsigned*>(ring + params.cq_off.tail);
+    m_cq_mask = *reinterpret_cast<unsigned*>(ring + params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+
+    m_buffer_count = buffer_count;
+    m_buffer_size = buffer_size;
+    m_buf_ring_size = buffer_count * sizeof(io_uring_buf);
+    void* buf_ring = mmap(nullptr, m_buf_ring_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    void* buffers = mmap(nullptr, static_cast<size_t>(buffer_count) * buffer_size,
+                         PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf_ring == MAP_FAILED || buffers == MAP_FAILED) {
+        if (buf_ring != MAP_FAILED) {
+            munmap(buf_ring, m_buf_ring_size);
+        }
+        if (buffers != MAP_FAILED) {
+            munmap(buffers, static_cast<size_t>(buffer_count) * buffer_size);
+        }
+        release();
+        return false;
+    }
+    m_buf_ring = static_cast<io_uring_buf*>(buf_ring);
+    memset(m_buf_ring, 0, m_buf_ring_size);
+    m_buffers = static_cast<char*>(buffers);
+
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(m_buf_ring);
+    reg.ring_entries = buffer_count;
+    reg.bgid = buffer_group;
+    if (syscall(__NR_io_uring_register, m_ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        release();
+        return false;
+    }
+
+    for (unsigned id = 0; id < buffer_count; ++id) {
+        recycle(id);
+    }
+    return true;
+}
+
+bool uring::reserve(unsigned count) {
+    if (m_sq_entries - (m_sq_local_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE)) >= count) {
+        return true;
+    }
+    submit();
+    return m_sq_entries - (m_sq_local_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE)) >= count;
+}
+
+io_uring_sqe* uring::next() {
+    unsigned head = __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+    if (m_sq_local_tail - head >= m_sq_entries) {
+        submit();
+        head = __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+        if (m_sq_local_tail - head >= m_sq_entries) {
+            return nullptr;
+        }
+    }
+
+    unsigned index = m_sq_local_tail & m_sq_mask;
+    m_sq_array[index] = index;
+    ++m_sq_local_tail;
+    ++m_to_submit;
+
+    io_uring_sqe* sqe = &m_sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+int uring::submit(unsigned wait_nr) {
+    __atomic_store_n(m_sq_tail, m_sq_local_tail, __ATOMIC_RELEASE);
+    unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int ret = static_cast<int>(syscall(__NR_io_uring_enter, m_ring_fd, m_to_submit, wait_nr, flags, nullptr, 0));
+    if (ret >= 0) {
+        m_to_submit = 0;
+    }
+    return ret;
+}
+
+io_uring_cqe* uring::peek() {
+    unsigned head = *m_cq_head;
+    if (head == __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+        return nullptr;
+    }
+    return &m_cqes[head & m_cq_mask];
+}
+
+void uring::advance() {
+    __atomic_store_n(m_cq_head, *m_cq_head + 1, __ATOMIC_RELEASE);
+}
+
+const char* uring::buffer(unsigned id) const {
+    return m_buffers + static_cast<size_t>(id) * m_buffer_size;
+}
+
+void uring::recycle(unsigned id) {
+    unsigned short* tail_ptr = &m_buf_ring[0].resv;
+    unsigned short tail = *tail_ptr;
+    io_uring_buf* buf = &m_buf_ring[tail & (m_buffer_count - 1)];
+    buf->addr = reinterpret_cast<uint64_t>(buffer(id));
+    buf->len = m_buffer_size;
+    buf->bid = static_cast<unsigned short>(id);
+    __atomic_store_n(tail_ptr, static_cast<unsigned short>(tail + 1), __ATOMIC_RELEASE);
+}
+
+}
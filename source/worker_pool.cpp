@@ -0,0 +1,75 @@
+#include "../include/worker_pool.hpp"
+
+namespace ghettp {
+
+worker_pool::worker_pool(size_t threads, size_t queue_depth, std::function<void(int)> handler)
+    : m_queue(queue_depth), m_queue_depth(queue_depth), m_handler(std::move(handler)) {
+    for (size_t i = 0; i < threads; ++i) {
+        m_workers.emplace_back(&worker_pool::work, this);
+    }
+}
+
+worker_pool::~worker_pool() {
+    shutdown();
+}
+
+bool worker_pool::submit(int client_socket) {
+    if (m_stopping) {
+        return false;
+    }
+
+    if (m_pending.fetch_add(1) >= m_queue_depth) {
+        --m_pending;
+        return false;
+    }
+
+    if (!m_queue.push(client_socket)) {
+        --m_pending;
+        return false;
+    }
+
+    if (m_sleeping > 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wakeup.notify_one();
+    }
+    return true;
+}
+
+void worker_pool::shutdown() {
+    if (m_stopping.exchange(true)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wakeup.notify_all();
+    }
+
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void worker_pool::work() {
+    while (true) {
+        int client_socket;
+        if (m_queue.pop(client_socket)) {
+            --m_pending;
+            m_handler(client_socket);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_sleeping;
+        m_wakeup.wait(lock, [this]() { return m_pending > 0 || m_stopping; });
+        --m_sleeping;
+
+        if (m_stopping && m_pending == 0) {
+            return;
+        }
+    }
+}
+
+}